@@ -12,7 +12,41 @@ functions. */
 #include <iostream>
 #include <iomanip>
 #include <vector>
-#include <cctype> 
+#include <cctype>
+#include <array>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <cerrno>
+#include <csignal>
+#include <ctime>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <queue>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <thread>
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+#if !defined(_WIN32)
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
 
 /* The code defines classes and interfaces for a chess game, including a ChessBoard class and a
 ChessPiece class. */
@@ -22,805 +56,5386 @@ enum class PieceColor {
     BLUE
 };
 
-// Forward declaration of ChessPiece class
-class ChessPiece;
+/* The code below defines the bitboard layer used by the fast move generator and attack code. Each
+square is numbered row * 8 + col, so bit 0 is A1 and bit 63 is H8, matching the board[row][col]
+layout used by ChessBoard. All geometry tables are generated at compile time. */
+// Bitboard with one bit per square
+using Bitboard = std::uint64_t;
 
-/* The above class defines an interface for common chess piece behaviors. */
-// Interface for common chess piece behaviors
-class ChessPieceInterface {
-public:
-    virtual bool isValidMove(int rowFrom, int colFrom, int rowTo, int colTo) const = 0;
-    virtual char getSymbol() const = 0;
-    virtual PieceColor getColor() const = 0;
-    virtual ~ChessPieceInterface() = default;
+// enum to represent different piece types
+enum PieceType {
+    PAWN,
+    KNIGHT,
+    BISHOP,
+    ROOK,
+    QUEEN,
+    KING,
+    PIECE_TYPE_NB,
+    NO_PIECE_TYPE = PIECE_TYPE_NB
 };
 
-// Class to represent the ChessBoard/* The ChessBoard class represents a chess board and provides
-//methods for moving pieces, checking for threats, and determining
+// enum to represent the eight ray directions, positive (increasing square index) ones first
+enum Direction {
+    NORTH,
+    EAST,
+    NORTH_EAST,
+    NORTH_WEST,
+    SOUTH,
+    WEST,
+    SOUTH_EAST,
+    SOUTH_WEST,
+    DIRECTION_NB
+};
 
+constexpr int COLOR_NB = 2;
+constexpr int SQUARE_NB = 64;
 
-class ChessBoard {
-private:
-    std::vector<std::vector<ChessPiece*>> board;
-    bool gameOver;
-    
-   // bool isPathClear(int rowFrom, int colFrom, int rowTo, int colTo) const;
+constexpr int colorIndex(PieceColor color) {
+    return color == PieceColor::RED ? 0 : 1;
+}
 
-public:
-    /* The above code is defining a class called ChessBoard. This class represents a chess board and
-    provides various methods for manipulating and checking the state of the board. */
-    ChessBoard();
-    ~ChessBoard();
+constexpr PieceColor opponentOf(PieceColor color) {
+    return color == PieceColor::RED ? PieceColor::BLUE : PieceColor::RED;
+}
 
-    void display() const;
-    ChessPiece* getPiece(int row, int col) const;
-    bool movePiece(int rowFrom, int colFrom, int rowTo, int colTo);
-    bool isSquareUnderThreat(int row, int col, PieceColor currentPlayer) const;
-    bool isCheckmate(PieceColor currentPlayer) ;
-    bool canEscapeCheck(int kingRow, int kingCol, PieceColor currentPlayer) const;
-    bool isMovePuttingKingInCheck(int fromRow, int fromCol, int toRow, int toCol, PieceColor currentPlayer) const;
-    bool isPlayerKingCaptured(PieceColor playerColor) const;
-    bool isGameOver();
-};
+constexpr int squareOf(int row, int col) {
+    return row * 8 + col;
+}
 
-/* The above code defines a set of classes for different chess pieces, each inheriting from a base
-class, with each class implementing its own isValidMove() and getSymbol() functions. */
-// Base class for ChessPiece
-class ChessPiece : public ChessPieceInterface {
-protected:
-    PieceColor color;
-    ChessBoard* board; 
-    bool isPathClear(int rowFrom, int colFrom, int rowTo, int colTo) const;
+constexpr int rowOf(int square) {
+    return square >> 3;
+}
 
-public:
-    ChessPiece(PieceColor pieceColor) : color(pieceColor), board(nullptr) {}
+constexpr int colOf(int square) {
+    return square & 7;
+}
 
-    // Setter function for the chessboard
-    void setChessBoard(ChessBoard* chessBoard) {
-        board = chessBoard;
+constexpr bool isOnBoard(int row, int col) {
+    return row >= 0 && row < 8 && col >= 0 && col < 8;
+}
+
+constexpr Bitboard squareBB(int square) {
+    return Bitboard(1) << square;
+}
+
+// Index of the least significant set bit (b must not be empty)
+inline int lsb(Bitboard b) {
+    return __builtin_ctzll(b);
+}
+
+// Index of the most significant set bit (b must not be empty)
+inline int msb(Bitboard b) {
+    return 63 - __builtin_clzll(b);
+}
+
+// Remove and return the least significant set bit
+inline int popLsb(Bitboard& b) {
+    int square = lsb(b);
+    b &= b - 1;
+    return square;
+}
+
+inline int popCount(Bitboard b) {
+    return __builtin_popcountll(b);
+}
+
+/* The function maps a piece symbol as returned by getSymbol() to its PieceType. */
+constexpr PieceType pieceTypeOf(char symbol) {
+    switch (symbol) {
+        case 'P': return PAWN;
+        case 'N': return KNIGHT;
+        case 'B': return BISHOP;
+        case 'R': return ROOK;
+        case 'Q': return QUEEN;
+        case 'K': return KING;
+        default:  return NO_PIECE_TYPE;
     }
-    
-    PieceColor getColor() const override {
-        return color;
+}
+
+constexpr int KnightSteps[8][2] = {{2, 1}, {1, 2}, {-1, 2}, {-2, 1}, {-2, -1}, {-1, -2}, {1, -2}, {2, -1}};
+constexpr int KingSteps[8][2] = {{1, 0}, {0, 1}, {1, 1}, {1, -1}, {-1, 0}, {0, -1}, {-1, 1}, {-1, -1}};
+constexpr int DirectionSteps[DIRECTION_NB][2] = {{1, 0}, {0, 1}, {1, 1}, {1, -1}, {-1, 0}, {0, -1}, {-1, 1}, {-1, -1}};
+
+using SquareTable = std::array<Bitboard, SQUARE_NB>;
+
+// Build a table of the squares reachable with a single step of a leaper (knight or king)
+constexpr SquareTable makeStepTable(const int (&steps)[8][2]) {
+    SquareTable table{};
+    for (int square = 0; square < SQUARE_NB; ++square) {
+        for (const auto& step : steps) {
+            int row = rowOf(square) + step[0];
+            int col = colOf(square) + step[1];
+            if (isOnBoard(row, col)) {
+                table[square] |= squareBB(squareOf(row, col));
+            }
+        }
     }
+    return table;
+}
 
-    bool isValidMove(int rowFrom, int colFrom, int rowTo, int colTo) const override {
-        // Default implementation (can be overridden by derived classes)
-        return true;
+/* Build the pawn attack table: the two squares diagonally forward, where a pawn captures. RED moves
+towards row 7 and BLUE towards row 0. Pawn pushes depend on the occupancy and are generated
+separately. */
+template <PieceColor Us>
+constexpr SquareTable makePawnAttackTable() {
+    constexpr int forward = (Us == PieceColor::RED) ? 1 : -1;
+    SquareTable table{};
+    for (int square = 0; square < SQUARE_NB; ++square) {
+        int row = rowOf(square);
+        int col = colOf(square);
+        for (int dc = -1; dc <= 1; dc += 2) {
+            if (isOnBoard(row + forward, col + dc)) {
+                table[square] |= squareBB(squareOf(row + forward, col + dc));
+            }
+        }
+    }
+    return table;
+}
+
+// Build the empty-board rays for every direction and square
+constexpr std::array<SquareTable, DIRECTION_NB> makeRayTable() {
+    std::array<SquareTable, DIRECTION_NB> table{};
+    for (int dir = 0; dir < DIRECTION_NB; ++dir) {
+        for (int square = 0; square < SQUARE_NB; ++square) {
+            int row = rowOf(square) + DirectionSteps[dir][0];
+            int col = colOf(square) + DirectionSteps[dir][1];
+            while (isOnBoard(row, col)) {
+                table[dir][square] |= squareBB(squareOf(row, col));
+                row += DirectionSteps[dir][0];
+                col += DirectionSteps[dir][1];
+            }
+        }
+    }
+    return table;
+}
+
+inline constexpr SquareTable KnightTable = makeStepTable(KnightSteps);
+inline constexpr SquareTable KingTable = makeStepTable(KingSteps);
+inline constexpr std::array<SquareTable, COLOR_NB> PawnAttackTable = {
+    makePawnAttackTable<PieceColor::RED>(), makePawnAttackTable<PieceColor::BLUE>()};
+inline constexpr std::array<SquareTable, DIRECTION_NB> RayTable = makeRayTable();
+
+// Squares a pawn of color Us standing on square attacks
+template <PieceColor Us>
+constexpr Bitboard pawnAttacks(int square) {
+    return PawnAttackTable[colorIndex(Us)][square];
+}
+
+// Squares from which a pawn of color Us attacks square
+template <PieceColor Us>
+constexpr Bitboard pawnAttackers(int square) {
+    return PawnAttackTable[colorIndex(opponentOf(Us))][square];
+}
+
+// Squares along one ray up to and including the first blocker
+template <Direction D>
+inline Bitboard rayAttacks(int square, Bitboard occupied) {
+    Bitboard ray = RayTable[D][square];
+    Bitboard blockers = ray & occupied;
+    if (blockers) {
+        int first = (D < SOUTH) ? lsb(blockers) : msb(blockers);
+        ray ^= RayTable[D][first];
+    }
+    return ray;
+}
+
+/* The function returns the squares a piece of type Pt standing on square attacks, given the set of
+occupied squares. Pawns are color dependent and use pawnAttacks() instead. */
+template <PieceType Pt>
+inline Bitboard attacksFrom(int square, Bitboard occupied) {
+    static_assert(Pt != PAWN, "pawn attacks depend on the color, use pawnAttacks()");
+    if constexpr (Pt == KNIGHT) {
+        return KnightTable[square];
+    } else if constexpr (Pt == KING) {
+        return KingTable[square];
+    } else if constexpr (Pt == BISHOP) {
+        return rayAttacks<NORTH_EAST>(square, occupied) | rayAttacks<NORTH_WEST>(square, occupied) |
+               rayAttacks<SOUTH_EAST>(square, occupied) | rayAttacks<SOUTH_WEST>(square, occupied);
+    } else if constexpr (Pt == ROOK) {
+        return rayAttacks<NORTH>(square, occupied) | rayAttacks<EAST>(square, occupied) |
+               rayAttacks<SOUTH>(square, occupied) | rayAttacks<WEST>(square, occupied);
+    } else {
+        return attacksFrom<BISHOP>(square, occupied) | attacksFrom<ROOK>(square, occupied);
+    }
+}
+
+// Build the table of squares strictly between two squares on a common line, empty if not aligned
+constexpr std::array<SquareTable, SQUARE_NB> makeBetweenTable() {
+    constexpr int opposite[DIRECTION_NB] = {SOUTH, WEST, SOUTH_WEST, SOUTH_EAST, NORTH, EAST, NORTH_WEST, NORTH_EAST};
+    std::array<SquareTable, SQUARE_NB> table{};
+    for (int from = 0; from < SQUARE_NB; ++from) {
+        for (int dir = 0; dir < DIRECTION_NB; ++dir) {
+            for (int to = 0; to < SQUARE_NB; ++to) {
+                if (RayTable[dir][from] & squareBB(to)) {
+                    table[from][to] = RayTable[dir][from] & RayTable[opposite[dir]][to];
+                }
+            }
+        }
     }
+    return table;
+}
+
+inline constexpr std::array<SquareTable, SQUARE_NB> BetweenTable = makeBetweenTable();
+
+// enum to represent the kind of a move, stored in the top two bits of a Move
+enum MoveType {
+    NORMAL,
+    PROMOTION = 1 << 14,
+    EN_PASSANT = 2 << 14,
+    CASTLING = 3 << 14
 };
 
-/* The Pawn class is a derived class of ChessPiece and implements the isValidMove and getSymbol
-functions. */
-// Derived class for Pawn
-class Pawn : public ChessPiece {
+/* A Move packs a move into 16 bits: the from square in bits 0-5, the to square in bits 6-11, the
+promotion piece (minus KNIGHT) in bits 12-13 and the MoveType in bits 14-15. Castling is stored as
+the king's move of two squares. The default Move, A1 to A1, stands for no move. */
+class Move {
 public:
-    using ChessPiece::ChessPiece;
+    constexpr Move() = default;
 
-    bool isValidMove(int rowFrom, int colFrom, int rowTo, int colTo) const override;
-    char getSymbol() const override;
+    constexpr Move(int from, int to) : data(static_cast<std::uint16_t>(from | (to << 6))) {}
+
+    static constexpr Move make(MoveType type, int from, int to, PieceType promotion = KNIGHT) {
+        Move move;
+        move.data = static_cast<std::uint16_t>(from | (to << 6) | ((promotion - KNIGHT) << 12) | type);
+        return move;
+    }
+
+    constexpr int from() const {
+        return data & 0x3F;
+    }
+
+    constexpr int to() const {
+        return (data >> 6) & 0x3F;
+    }
+
+    constexpr MoveType type() const {
+        return static_cast<MoveType>(data & (3 << 14));
+    }
+
+    // The piece a pawn promotes to; only meaningful for PROMOTION moves
+    constexpr PieceType promotion() const {
+        return static_cast<PieceType>(KNIGHT + ((data >> 12) & 3));
+    }
+
+    constexpr std::uint16_t raw() const {
+        return data;
+    }
+
+    static constexpr Move fromRaw(std::uint16_t raw) {
+        Move move;
+        move.data = raw;
+        return move;
+    }
+
+    constexpr explicit operator bool() const {
+        return data != 0;
+    }
+
+    constexpr bool operator==(Move other) const {
+        return data == other.data;
+    }
+
+    constexpr bool operator!=(Move other) const {
+        return data != other.data;
+    }
+
+private:
+    std::uint16_t data = 0;
 };
 
-/* The Rook class is a derived class of ChessPiece and overrides the isValidMove and getSymbol
-functions. */
-// Derived class for Rook
-class Rook : public ChessPiece {
+/**
+ * The MoveList class is a list of moves stored inline, so generating the moves of a position does
+ * not allocate. No legal chess position has more than 218 moves; moves beyond the capacity are
+ * dropped rather than written out of bounds.
+ */
+class MoveList {
 public:
-    using ChessPiece::ChessPiece;
+    static constexpr std::size_t Capacity = 256;
 
-    bool isValidMove(int rowFrom, int colFrom, int rowTo, int colTo) const override;
-    char getSymbol() const override;
+    void push_back(Move move) {
+        if (count < Capacity) {
+            moves[count++] = move;
+        }
+    }
+
+    void clear() {
+        count = 0;
+    }
+
+    // Shrink the list to its first size moves
+    void resize(std::size_t size) {
+        count = std::min(size, count);
+    }
+
+    std::size_t size() const {
+        return count;
+    }
+
+    bool empty() const {
+        return count == 0;
+    }
+
+    Move& operator[](std::size_t index) {
+        return moves[index];
+    }
+
+    Move operator[](std::size_t index) const {
+        return moves[index];
+    }
+
+    const Move* begin() const {
+        return moves.data();
+    }
+
+    const Move* end() const {
+        return moves.data() + count;
+    }
+
+    bool contains(Move move) const {
+        return std::find(begin(), end(), move) != end();
+    }
+
+private:
+    std::array<Move, Capacity> moves;
+    std::size_t count = 0;
 };
 
-/* The Knight class is a subclass of ChessPiece and overrides the isValidMove and getSymbol functions. */
-class Knight : public ChessPiece {
-public:
-    using ChessPiece::ChessPiece;
-    
-    bool isValidMove(int rowFrom, int colFrom, int rowTo, int colTo) const override;
-    char getSymbol() const override;
-     
+// Coordinate notation of move, e.g. "e2e4", or "e7e8q" for a promotion
+inline std::string moveText(Move move) {
+    std::string text;
+    text += static_cast<char>('a' + colOf(move.from()));
+    text += static_cast<char>('1' + rowOf(move.from()));
+    text += static_cast<char>('a' + colOf(move.to()));
+    text += static_cast<char>('1' + rowOf(move.to()));
+    if (move.type() == PROMOTION) {
+        text += "pnbrqk"[move.promotion()];
+    }
+    return text;
+}
+
+// enum to represent the castling rights, one bit per king and side
+enum CastlingRight {
+    NO_CASTLING = 0,
+    RED_KING_SIDE = 1,
+    RED_QUEEN_SIDE = 2,
+    BLUE_KING_SIDE = 4,
+    BLUE_QUEEN_SIDE = 8,
+    ALL_CASTLING = 15
 };
 
-/* The Bishop class is a subclass of ChessPiece and overrides the isValidMove and getSymbol functions. */
-class Bishop : public ChessPiece {
-public:
-    using ChessPiece::ChessPiece;
-    
-    bool isValidMove(int rowFrom, int colFrom, int rowTo, int colTo) const override;
-    char getSymbol() const override;
+// The castling rights kept when a piece moves from or to each square: moving the king or a rook
+// from its starting square, or capturing a rook there, gives up the matching rights
+constexpr std::array<std::uint8_t, SQUARE_NB> makeCastlingMask() {
+    std::array<std::uint8_t, SQUARE_NB> mask{};
+    for (int square = 0; square < SQUARE_NB; ++square) {
+        mask[square] = ALL_CASTLING;
+    }
+    mask[squareOf(0, 4)] &= ~(RED_KING_SIDE | RED_QUEEN_SIDE);
+    mask[squareOf(0, 7)] &= ~RED_KING_SIDE;
+    mask[squareOf(0, 0)] &= ~RED_QUEEN_SIDE;
+    mask[squareOf(7, 4)] &= ~(BLUE_KING_SIDE | BLUE_QUEEN_SIDE);
+    mask[squareOf(7, 7)] &= ~BLUE_KING_SIDE;
+    mask[squareOf(7, 0)] &= ~BLUE_QUEEN_SIDE;
+    return mask;
+}
+
+inline constexpr std::array<std::uint8_t, SQUARE_NB> CastlingMask = makeCastlingMask();
+
+// Row of the first rank of color Us, where its king and rooks start
+template <PieceColor Us>
+constexpr int homeRow() {
+    return Us == PieceColor::RED ? 0 : 7;
+}
+
+// The castling right of color on the king side if kingSide is true, else on the queen side
+constexpr int castlingRight(PieceColor color, bool kingSide) {
+    return (kingSide ? RED_KING_SIDE : RED_QUEEN_SIDE) << (2 * colorIndex(color));
+}
+
+/* Zobrist keys for hashing positions: one random 64-bit key per (color, piece type, square) and one
+for the side to move. The keys come from a fixed-seed SplitMix64 sequence evaluated at compile time,
+so hashes are identical across runs and can be stored on disk. The castling rights and the file of
+the en-passant square have keys of their own. */
+using Key = std::uint64_t;
+
+constexpr Key splitMix64(Key& state) {
+    Key z = (state += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+struct ZobristKeys {
+    std::array<std::array<std::array<Key, SQUARE_NB>, PIECE_TYPE_NB>, COLOR_NB> piece{};
+    Key side = 0;
+    std::array<Key, ALL_CASTLING + 1> castling{};
+    std::array<Key, 8> enPassant{};
 };
 
-/* The Queen class is a subclass of ChessPiece and overrides the isValidMove and getSymbol functions. */
-class Queen : public ChessPiece {
-public:
-    using ChessPiece::ChessPiece;
-    
-    bool isValidMove(int rowFrom, int colFrom, int rowTo, int colTo) const override;
-    char getSymbol() const override;
+constexpr ZobristKeys makeZobristKeys() {
+    ZobristKeys keys{};
+    Key state = 0x2023121716320000ULL;
+    for (int color = 0; color < COLOR_NB; ++color) {
+        for (int type = 0; type < PIECE_TYPE_NB; ++type) {
+            for (int square = 0; square < SQUARE_NB; ++square) {
+                keys.piece[color][type][square] = splitMix64(state);
+            }
+        }
+    }
+    keys.side = splitMix64(state);
+    // No rights hash to 0, so the key of a position without castling rights is unchanged
+    for (int rights = 1; rights <= ALL_CASTLING; ++rights) {
+        keys.castling[rights] = splitMix64(state);
+    }
+    for (int col = 0; col < 8; ++col) {
+        keys.enPassant[col] = splitMix64(state);
+    }
+    return keys;
+}
+
+inline constexpr ZobristKeys Zobrist = makeZobristKeys();
+
+// The state makeMove() overwrites, so that unmakeMove() can restore it
+struct UndoInfo {
+    Key key;
+    Key pawnKey;
+    PieceType captured;
+    std::uint8_t castlingRights;
+    std::int8_t epSquare;
 };
 
-/* The King class is a subclass of ChessPiece and overrides the isValidMove and getSymbol functions. */
-class King : public ChessPiece {
-public:
-    using ChessPiece::ChessPiece;
-    
-    bool isValidMove(int rowFrom, int colFrom, int rowTo, int colTo) const override;
-    char getSymbol() const override;
+/* The Position struct is a compact bitboard mirror of the pieces on a ChessBoard, with the castling
+rights and the en-passant square. It holds no pointers, so it is cheap to copy and safe to hand to
+worker threads. The Zobrist key of the position, and a second key covering only the pawns, are
+updated incrementally as pieces are put and removed. The en-passant square is only set when a pawn
+of the side to move stands next to the pawn that just advanced two squares. */
+struct Position {
+    std::array<Bitboard, COLOR_NB> byColor{};
+    std::array<Bitboard, PIECE_TYPE_NB> byType{};
+    std::array<std::int8_t, SQUARE_NB> typeOn{};
+    Key key = 0;
+    Key pawnKey = 0;
+    std::uint8_t castlingRights = NO_CASTLING;
+    std::int8_t epSquare = -1;
+
+    Position() {
+        typeOn.fill(NO_PIECE_TYPE);
+    }
+
+    Bitboard occupied() const {
+        return byColor[0] | byColor[1];
+    }
+
+    Bitboard pieces(PieceColor color) const {
+        return byColor[colorIndex(color)];
+    }
+
+    Bitboard pieces(PieceColor color, PieceType type) const {
+        return byColor[colorIndex(color)] & byType[type];
+    }
+
+    PieceType pieceTypeOn(int square) const {
+        return static_cast<PieceType>(typeOn[square]);
+    }
+
+    PieceColor colorOn(int square) const {
+        return (byColor[0] & squareBB(square)) ? PieceColor::RED : PieceColor::BLUE;
+    }
+
+    bool isEmpty(int square) const {
+        return typeOn[square] == NO_PIECE_TYPE;
+    }
+
+    // Square of the king of the given color, or -1 if it is not on the board
+    int kingSquare(PieceColor color) const {
+        Bitboard king = pieces(color, KING);
+        return king ? lsb(king) : -1;
+    }
+
+    void put(int square, PieceColor color, PieceType type) {
+        byColor[colorIndex(color)] |= squareBB(square);
+        byType[type] |= squareBB(square);
+        typeOn[square] = static_cast<std::int8_t>(type);
+        key ^= Zobrist.piece[colorIndex(color)][type][square];
+        if (type == PAWN) {
+            pawnKey ^= Zobrist.piece[colorIndex(color)][PAWN][square];
+        }
+    }
+
+    void remove(int square) {
+        if (isEmpty(square)) {
+            return;
+        }
+        int color = colorIndex(colorOn(square));
+        key ^= Zobrist.piece[color][typeOn[square]][square];
+        if (typeOn[square] == PAWN) {
+            pawnKey ^= Zobrist.piece[color][PAWN][square];
+        }
+        byColor[color] &= ~squareBB(square);
+        byType[typeOn[square]] &= ~squareBB(square);
+        typeOn[square] = NO_PIECE_TYPE;
+    }
+
+    // Move the piece on from to to, removing whatever stood on to
+    void move(int from, int to) {
+        PieceColor color = colorOn(from);
+        PieceType type = pieceTypeOn(from);
+        remove(to);
+        remove(from);
+        put(to, color, type);
+    }
+
+    void setCastlingRights(int rights) {
+        key ^= Zobrist.castling[castlingRights] ^ Zobrist.castling[rights];
+        castlingRights = static_cast<std::uint8_t>(rights);
+    }
+
+    // Set the en-passant square, or clear it with -1
+    void setEnPassant(int square) {
+        if (epSquare >= 0) {
+            key ^= Zobrist.enPassant[colOf(epSquare)];
+        }
+        if (square >= 0) {
+            key ^= Zobrist.enPassant[colOf(square)];
+        }
+        epSquare = static_cast<std::int8_t>(square);
+    }
+
+    bool isCapture(Move move) const {
+        return !isEmpty(move.to()) || move.type() == EN_PASSANT;
+    }
+
+    void makeMove(Move move, UndoInfo& undo);
+    void unmakeMove(Move move, const UndoInfo& undo);
+
+    // Play move on this position when it need not be taken back
+    void makeMove(Move move) {
+        UndoInfo undo;
+        makeMove(move, undo);
+    }
 };
 
+// The squares the rook moves from and to when the king castles to kingTo
+constexpr int castlingRookFrom(int kingTo) {
+    return colOf(kingTo) == 6 ? kingTo + 1 : kingTo - 2;
+}
+
+constexpr int castlingRookTo(int kingTo) {
+    return colOf(kingTo) == 6 ? kingTo - 1 : kingTo + 1;
+}
+
+/* The function plays move, which must be legal or at least pseudo-legal, and records in undo what
+unmakeMove() needs to take it back. Castling also moves the rook, en passant removes the pawn
+behind the target square and a promotion replaces the pawn. */
+inline void Position::makeMove(Move move, UndoInfo& undo) {
+    const int from = move.from();
+    const int to = move.to();
+    const PieceColor us = colorOn(from);
+    undo = {key, pawnKey, pieceTypeOn(to), castlingRights, epSquare};
+    setEnPassant(-1);
+
+    switch (move.type()) {
+        case CASTLING:
+            this->move(from, to);
+            this->move(castlingRookFrom(to), castlingRookTo(to));
+            break;
+        case EN_PASSANT:
+            undo.captured = PAWN;
+            remove(squareOf(rowOf(from), colOf(to)));
+            this->move(from, to);
+            break;
+        case PROMOTION:
+            remove(to);
+            remove(from);
+            put(to, us, move.promotion());
+            break;
+        default:
+            this->move(from, to);
+            if (pieceTypeOn(to) == PAWN && (to - from == 16 || from - to == 16)) {
+                // A pawn that advanced two squares may be taken en passant by a pawn next to it
+                const int passed = (from + to) / 2;
+                const Bitboard takers = us == PieceColor::RED ? pawnAttackers<PieceColor::BLUE>(passed)
+                                                              : pawnAttackers<PieceColor::RED>(passed);
+                if (takers & byColor[colorIndex(opponentOf(us))] & byType[PAWN]) {
+                    setEnPassant(passed);
+                }
+            }
+            break;
+    }
+    setCastlingRights(castlingRights & CastlingMask[from] & CastlingMask[to]);
+}
+
+// Take back move, which must be the last move made with makeMove(move, undo)
+inline void Position::unmakeMove(Move move, const UndoInfo& undo) {
+    const int from = move.from();
+    const int to = move.to();
+    const PieceColor us = colorOn(to);
+    const PieceColor them = opponentOf(us);
+
+    switch (move.type()) {
+        case CASTLING:
+            this->move(to, from);
+            this->move(castlingRookTo(to), castlingRookFrom(to));
+            break;
+        case EN_PASSANT:
+            this->move(to, from);
+            put(squareOf(rowOf(from), colOf(to)), them, PAWN);
+            break;
+        case PROMOTION:
+            remove(to);
+            put(from, us, PAWN);
+            break;
+        default:
+            this->move(to, from);
+            break;
+    }
+    if (move.type() != EN_PASSANT && undo.captured != NO_PIECE_TYPE) {
+        put(to, them, undo.captured);
+    }
+    castlingRights = undo.castlingRights;
+    epSquare = undo.epSquare;
+    key = undo.key;
+    pawnKey = undo.pawnKey;
+}
+
+/* The function returns the move of the piece on from to to in position, with the type that kind of
+move needs: a king moving two squares castles, a pawn moving diagonally onto the en-passant square
+takes en passant and a pawn reaching the last row promotes to promotion. */
+inline Move moveFor(const Position& position, int from, int to, PieceType promotion = QUEEN) {
+    const PieceType type = position.pieceTypeOn(from);
+    if (type == KING && std::abs(colOf(to) - colOf(from)) == 2 && rowOf(to) == rowOf(from)) {
+        return Move::make(CASTLING, from, to);
+    }
+    if (type == PAWN) {
+        if (to == position.epSquare && colOf(to) != colOf(from)) {
+            return Move::make(EN_PASSANT, from, to);
+        }
+        if (rowOf(to) == 0 || rowOf(to) == 7) {
+            return Move::make(PROMOTION, from, to, promotion);
+        }
+    }
+    return Move(from, to);
+}
+
+// Hash of a position together with the side to move
+inline Key positionKey(const Position& position, PieceColor sideToMove) {
+    return position.key ^ (sideToMove == PieceColor::BLUE ? Zobrist.side : 0);
+}
+
+/* The function appends the board in position to out as text: a header of column letters, then one
+line per row with each piece symbol colored with ANSI escapes (red or blue). */
+inline void renderBoard(const Position& position, std::string& out) {
+    out += "    A  B  C  D  E  F  G  H\n";
+    for (int i = 0; i < 8; ++i) {
+        out += static_cast<char>('1' + i);
+        out += " |";
+        for (int j = 0; j < 8; ++j) {
+            int square = squareOf(i, j);
+            if (position.isEmpty(square)) {
+                out += " .|";
+            } else {
+                out += position.colorOn(square) == PieceColor::RED ? "\033[1;31m " : "\033[1;34m ";
+                out += "PNBRQK"[position.pieceTypeOn(square)];
+                out += "\033[0m|";
+            }
+        }
+        out += '\n';
+    }
+}
+
+/* The function writes position in Forsyth-Edwards Notation, with RED as white (upper case) and BLUE
+as black. Row 7 is written first. */
+inline std::string toFen(const Position& position, PieceColor sideToMove) {
+    std::string fen;
+    for (int row = 7; row >= 0; --row) {
+        int empty = 0;
+        for (int col = 0; col < 8; ++col) {
+            int square = squareOf(row, col);
+            if (position.isEmpty(square)) {
+                ++empty;
+                continue;
+            }
+            if (empty) {
+                fen += static_cast<char>('0' + empty);
+                empty = 0;
+            }
+            char symbol = "PNBRQK"[position.pieceTypeOn(square)];
+            fen += position.colorOn(square) == PieceColor::RED ? symbol : static_cast<char>(std::tolower(symbol));
+        }
+        if (empty) {
+            fen += static_cast<char>('0' + empty);
+        }
+        if (row > 0) {
+            fen += '/';
+        }
+    }
+    fen += sideToMove == PieceColor::RED ? " w " : " b ";
+    for (int i = 0; i < 4; ++i) {
+        if (position.castlingRights & (1 << i)) {
+            fen += "KQkq"[i];
+        }
+    }
+    if (!position.castlingRights) {
+        fen += '-';
+    }
+    fen += ' ';
+    if (position.epSquare >= 0) {
+        fen += static_cast<char>('a' + colOf(position.epSquare));
+        fen += static_cast<char>('1' + rowOf(position.epSquare));
+    } else {
+        fen += '-';
+    }
+    return fen + " 0 1";
+}
+
+/* The function reads the piece placement, side to move, castling rights and en-passant square of a
+FEN string as written by toFen(). Missing fields default to no rights and no en-passant square,
+and an en-passant square no pawn of the side to move can take on is dropped. It returns false if
+the placement or a field is malformed. */
+inline bool parseFen(const std::string& fen, Position& position, PieceColor& sideToMove) {
+    position = Position();
+    int row = 7;
+    int col = 0;
+    std::size_t i = 0;
+    for (; i < fen.size() && fen[i] != ' '; ++i) {
+        char c = fen[i];
+        if (c == '/') {
+            if (col != 8 || --row < 0) {
+                return false;
+            }
+            col = 0;
+        } else if (c >= '1' && c <= '8') {
+            col += c - '0';
+        } else {
+            PieceType type = pieceTypeOf(static_cast<char>(std::toupper(c)));
+            if (type == NO_PIECE_TYPE || col > 7) {
+                return false;
+            }
+            position.put(squareOf(row, col++), std::isupper(c) ? PieceColor::RED : PieceColor::BLUE, type);
+        }
+        if (col > 8) {
+            return false;
+        }
+    }
+    if (row != 0 || col != 8) {
+        return false;
+    }
+    std::istringstream fields(fen.substr(i));
+    std::string side = "w";
+    std::string castling = "-";
+    std::string enPassant = "-";
+    fields >> side >> castling >> enPassant;
+    if (side != "w" && side != "b") {
+        return false;
+    }
+    sideToMove = side == "b" ? PieceColor::BLUE : PieceColor::RED;
+
+    int rights = NO_CASTLING;
+    for (char c : castling) {
+        std::size_t right = std::string_view("KQkq").find(c);
+        if (right == std::string_view::npos) {
+            if (c != '-') {
+                return false;
+            }
+            continue;
+        }
+        rights |= 1 << right;
+    }
+    position.setCastlingRights(rights);
+
+    if (enPassant != "-") {
+        int epCol = enPassant[0] - 'a';
+        int epRow = enPassant.size() == 2 ? enPassant[1] - '1' : -1;
+        if (!isOnBoard(epRow, epCol)) {
+            return false;
+        }
+        const int square = squareOf(epRow, epCol);
+        const bool redToMove = sideToMove == PieceColor::RED;
+        const int victim = redToMove ? square - 8 : square + 8;
+        const Bitboard takers = redToMove ? pawnAttackers<PieceColor::RED>(square) : pawnAttackers<PieceColor::BLUE>(square);
+        if (epRow == (redToMove ? 5 : 2) && (takers & position.pieces(sideToMove, PAWN)) &&
+            (position.pieces(opponentOf(sideToMove), PAWN) & squareBB(victim)) && position.isEmpty(square)) {
+            position.setEnPassant(square);
+        }
+    }
+    return true;
+}
+
+/* The function appends the moves of every piece of type Pt and color Us to moves. Targets follow the
+isValidMove() rules of each piece, excluding squares occupied by the mover's own pieces, exactly as
+ChessBoard::movePiece accepts them. The king is not checked for safety. */
+template <PieceColor Us, PieceType Pt>
+void generatePieceMoves(const Position& position, MoveList& moves) {
+    static_assert(Pt != PAWN, "pawn moves are generated by generatePawnMoves()");
+    const Bitboard notOwn = ~position.pieces(Us);
+    const Bitboard occupied = position.occupied();
+    Bitboard pieces = position.pieces(Us, Pt);
+    while (pieces) {
+        int from = popLsb(pieces);
+        Bitboard targets = attacksFrom<Pt>(from, occupied) & notOwn;
+        while (targets) {
+            moves.push_back(Move(from, popLsb(targets)));
+        }
+    }
+}
+
+/* Generate the pawn moves of color Us: one step forward onto an empty square, two steps from the
+starting row over an empty square, diagonal captures and captures en passant. A pawn reaching the
+last row promotes, so each such move is generated once per promotion piece, queen first. */
+template <PieceColor Us>
+void generatePawnMoves(const Position& position, MoveList& moves) {
+    constexpr PieceColor Them = opponentOf(Us);
+    constexpr int forward = (Us == PieceColor::RED) ? 8 : -8;
+    constexpr int startRow = (Us == PieceColor::RED) ? 1 : 6;
+    constexpr int lastRow = (Us == PieceColor::RED) ? 7 : 0;
+    const Bitboard empty = ~position.occupied();
+    const Bitboard enemies = position.pieces(Them);
+    const int ep = position.epSquare;
+
+    Bitboard pawns = position.pieces(Us, PAWN);
+    while (pawns) {
+        const int from = popLsb(pawns);
+        Bitboard targets = pawnAttacks<Us>(from) & enemies;
+        if (empty & squareBB(from + forward)) {
+            targets |= squareBB(from + forward);
+            if (rowOf(from) == startRow && (empty & squareBB(from + 2 * forward))) {
+                targets |= squareBB(from + 2 * forward);
+            }
+        }
+        while (targets) {
+            const int to = popLsb(targets);
+            if (rowOf(to) == lastRow) {
+                moves.push_back(Move::make(PROMOTION, from, to, QUEEN));
+                moves.push_back(Move::make(PROMOTION, from, to, ROOK));
+                moves.push_back(Move::make(PROMOTION, from, to, BISHOP));
+                moves.push_back(Move::make(PROMOTION, from, to, KNIGHT));
+            } else {
+                moves.push_back(Move(from, to));
+            }
+        }
+        if (ep >= 0 && (pawnAttacks<Us>(from) & squareBB(ep)) &&
+            (position.pieces(Them, PAWN) & squareBB(ep - forward))) {
+            moves.push_back(Move::make(EN_PASSANT, from, ep));
+        }
+    }
+}
+
+/* Generate the castling moves of color Us: the king moves two squares towards a rook on its
+starting square, with every square between them empty and the right not given up. Whether the
+king is in check or passes an attacked square is left to the legality check. */
+template <PieceColor Us>
+void generateCastlingMoves(const Position& position, MoveList& moves) {
+    constexpr int king = squareOf(homeRow<Us>(), 4);
+    if (!(position.pieces(Us, KING) & squareBB(king))) {
+        return;
+    }
+    const Bitboard occupied = position.occupied();
+    const Bitboard rooks = position.pieces(Us, ROOK);
+    if ((position.castlingRights & castlingRight(Us, true)) && (rooks & squareBB(king + 3)) &&
+        !(BetweenTable[king][king + 3] & occupied)) {
+        moves.push_back(Move::make(CASTLING, king, king + 2));
+    }
+    if ((position.castlingRights & castlingRight(Us, false)) && (rooks & squareBB(king - 4)) &&
+        !(BetweenTable[king][king - 4] & occupied)) {
+        moves.push_back(Move::make(CASTLING, king, king - 2));
+    }
+}
+
+// Generate the moves of all pieces of color Us
+template <PieceColor Us>
+void generateMoves(const Position& position, MoveList& moves) {
+    generatePawnMoves<Us>(position, moves);
+    generatePieceMoves<Us, KNIGHT>(position, moves);
+    generatePieceMoves<Us, BISHOP>(position, moves);
+    generatePieceMoves<Us, ROOK>(position, moves);
+    generatePieceMoves<Us, QUEEN>(position, moves);
+    generatePieceMoves<Us, KING>(position, moves);
+    generateCastlingMoves<Us>(position, moves);
+}
+
+/* The function checks if any piece of color Them attacks square. On a square holding a piece of the
+other color it answers the same question as ChessBoard::isSquareUnderThreat. */
+template <PieceColor Them>
+bool isAttackedBy(const Position& position, int square) {
+    const Bitboard occupied = position.occupied();
+    const Bitboard queens = position.pieces(Them, QUEEN);
+    return (pawnAttackers<Them>(square) & position.pieces(Them, PAWN)) ||
+           (KnightTable[square] & position.pieces(Them, KNIGHT)) ||
+           (KingTable[square] & position.pieces(Them, KING)) ||
+           (attacksFrom<BISHOP>(square, occupied) & (position.pieces(Them, BISHOP) | queens)) ||
+           (attacksFrom<ROOK>(square, occupied) & (position.pieces(Them, ROOK) | queens));
+}
+
+/* The code below computes every square attacked by one side in a single pass. Sliders are handled
+with Kogge-Stone parallel-prefix fills: each fill propagates all sliders of one direction at once in
+three shift steps, instead of walking each slider square by square. With AVX2 the four positive
+directions share one 256-bit register and the four negative directions another. */
+constexpr Bitboard NotColA = ~Bitboard(0x0101010101010101);
+constexpr Bitboard NotColH = ~Bitboard(0x8080808080808080);
+
+// Shift amounts and wrap masks of the directions; a mask keeps squares a shift may legally land on
+constexpr int DirectionShift[DIRECTION_NB] = {8, 1, 9, 7, 8, 1, 7, 9};
+constexpr Bitboard DirectionMask[DIRECTION_NB] = {~Bitboard(0), NotColA, NotColA, NotColH,
+                                                  ~Bitboard(0), NotColH, NotColA, NotColH};
+
+// Attacks along direction D of every slider in sliders, stopping at (and including) blockers
+template <Direction D>
+inline Bitboard koggeStoneAttacks(Bitboard sliders, Bitboard empty) {
+    constexpr int s = DirectionShift[D];
+    constexpr Bitboard mask = DirectionMask[D];
+    auto shift = [](Bitboard b, int n) { return (D < SOUTH) ? (b << n) : (b >> n); };
+    Bitboard propagator = empty & mask;
+    sliders |= propagator & shift(sliders, s);
+    propagator &= shift(propagator, s);
+    sliders |= propagator & shift(sliders, 2 * s);
+    propagator &= shift(propagator, 2 * s);
+    sliders |= propagator & shift(sliders, 4 * s);
+    return shift(sliders, s) & mask;
+}
+
+#if defined(__AVX2__)
+/* Fill four directions at once. Lanes hold NORTH, EAST, NORTH_EAST, NORTH_WEST when Positive is true,
+and SOUTH, WEST, SOUTH_EAST, SOUTH_WEST otherwise. */
+template <bool Positive>
+inline Bitboard koggeStoneAttacks4(Bitboard orthogonal, Bitboard diagonal, Bitboard empty) {
+    constexpr int base = Positive ? NORTH : SOUTH;
+    const __m256i mask = _mm256_setr_epi64x(DirectionMask[base], DirectionMask[base + 1],
+                                            DirectionMask[base + 2], DirectionMask[base + 3]);
+    const __m256i s1 = _mm256_setr_epi64x(DirectionShift[base], DirectionShift[base + 1],
+                                          DirectionShift[base + 2], DirectionShift[base + 3]);
+    const __m256i s2 = _mm256_add_epi64(s1, s1);
+    const __m256i s4 = _mm256_add_epi64(s2, s2);
+    auto shift = [](__m256i b, __m256i n) { return Positive ? _mm256_sllv_epi64(b, n) : _mm256_srlv_epi64(b, n); };
+
+    __m256i gen = _mm256_setr_epi64x(orthogonal, orthogonal, diagonal, diagonal);
+    __m256i pro = _mm256_and_si256(_mm256_set1_epi64x(empty), mask);
+    gen = _mm256_or_si256(gen, _mm256_and_si256(pro, shift(gen, s1)));
+    pro = _mm256_and_si256(pro, shift(pro, s1));
+    gen = _mm256_or_si256(gen, _mm256_and_si256(pro, shift(gen, s2)));
+    pro = _mm256_and_si256(pro, shift(pro, s2));
+    gen = _mm256_or_si256(gen, _mm256_and_si256(pro, shift(gen, s4)));
+    gen = _mm256_and_si256(shift(gen, s1), mask);
+
+    // OR the four lanes together
+    __m128i half = _mm_or_si128(_mm256_castsi256_si128(gen), _mm256_extracti128_si256(gen, 1));
+    return static_cast<Bitboard>(_mm_cvtsi128_si64(half) | _mm_extract_epi64(half, 1));
+}
+#endif
+
+// All squares attacked by the given orthogonal (rook, queen) and diagonal (bishop, queen) sliders
+inline Bitboard sliderAttacks(Bitboard orthogonal, Bitboard diagonal, Bitboard empty) {
+#if defined(__AVX2__)
+    return koggeStoneAttacks4<true>(orthogonal, diagonal, empty) |
+           koggeStoneAttacks4<false>(orthogonal, diagonal, empty);
+#else
+    return koggeStoneAttacks<NORTH>(orthogonal, empty) | koggeStoneAttacks<SOUTH>(orthogonal, empty) |
+           koggeStoneAttacks<EAST>(orthogonal, empty) | koggeStoneAttacks<WEST>(orthogonal, empty) |
+           koggeStoneAttacks<NORTH_EAST>(diagonal, empty) | koggeStoneAttacks<NORTH_WEST>(diagonal, empty) |
+           koggeStoneAttacks<SOUTH_EAST>(diagonal, empty) | koggeStoneAttacks<SOUTH_WEST>(diagonal, empty);
+#endif
+}
+
+// Squares attacked diagonally by the pawns of color Us
+template <PieceColor Us>
+constexpr Bitboard pawnCaptureSquares(Bitboard pawns) {
+    if constexpr (Us == PieceColor::RED) {
+        return ((pawns & NotColA) << 7) | ((pawns & NotColH) << 9);
+    } else {
+        return ((pawns & NotColH) >> 7) | ((pawns & NotColA) >> 9);
+    }
+}
+
+// All squares a knight in knights can jump to
+constexpr Bitboard knightTargetsAll(Bitboard knights) {
+    constexpr Bitboard NotColAB = NotColA & (NotColA << 1);
+    constexpr Bitboard NotColGH = NotColH & (NotColH >> 1);
+    return ((knights & NotColH) << 17) | ((knights & NotColA) << 15) | ((knights & NotColGH) << 10) |
+           ((knights & NotColAB) << 6) | ((knights & NotColA) >> 17) | ((knights & NotColH) >> 15) |
+           ((knights & NotColAB) >> 10) | ((knights & NotColGH) >> 6);
+}
+
+/* The function returns every square some piece of color Them attacks. A square s is in the result
+exactly when isAttackedBy<Them>(position, s) is true, so one call replaces 64 probes. */
+template <PieceColor Them>
+Bitboard attackedSquares(const Position& position) {
+    const Bitboard queens = position.pieces(Them, QUEEN);
+    const Bitboard kings = position.pieces(Them, KING);
+    Bitboard attacks = sliderAttacks(position.pieces(Them, ROOK) | queens, position.pieces(Them, BISHOP) | queens,
+                                     ~position.occupied());
+    attacks |= pawnCaptureSquares<Them>(position.pieces(Them, PAWN));
+    attacks |= knightTargetsAll(position.pieces(Them, KNIGHT));
+    if (kings) {
+        attacks |= KingTable[lsb(kings)];
+    }
+    return attacks;
+}
+
+/* The function returns the pieces of color Them among occupied that attack square. Removing a
+piece from occupied both drops it as an attacker and lets sliders behind it through. */
+template <PieceColor Them>
+Bitboard attackersTo(const Position& position, int square, Bitboard occupied) {
+    const Bitboard queens = position.pieces(Them, QUEEN);
+    return ((pawnAttackers<Them>(square) & position.pieces(Them, PAWN)) |
+            (KnightTable[square] & position.pieces(Them, KNIGHT)) |
+            (KingTable[square] & position.pieces(Them, KING)) |
+            (attacksFrom<BISHOP>(square, occupied) & (position.pieces(Them, BISHOP) | queens)) |
+            (attacksFrom<ROOK>(square, occupied) & (position.pieces(Them, ROOK) | queens))) &
+           occupied;
+}
+
+/* The LegalityInfo struct holds the per-position data needed to decide if a move of color Us leaves
+its king under threat: the pieces giving check, the squares the king may not step on and the pinned
+pieces with the line each one is pinned along. It is computed once and reused for every candidate. */
+template <PieceColor Us>
+struct LegalityInfo {
+    static constexpr PieceColor Them = opponentOf(Us);
+
+    int kingSquare;
+    Bitboard checkers = 0;
+    Bitboard kingDanger = 0;
+    Bitboard pinned = 0;
+    std::array<Bitboard, SQUARE_NB> pinLine{};
+
+    explicit LegalityInfo(const Position& position) : kingSquare(position.kingSquare(Us)) {
+        if (kingSquare < 0) {
+            return;
+        }
+        const Bitboard occupied = position.occupied();
+        checkers = attackersTo<Them>(position, kingSquare, occupied);
+
+        // Sliders see through the king's current square when it steps away along their line
+        Position withoutKing = position;
+        withoutKing.remove(kingSquare);
+        kingDanger = attackedSquares<Them>(withoutKing);
+
+        const Bitboard queens = position.pieces(Them, QUEEN);
+        Bitboard snipers = (attacksFrom<ROOK>(kingSquare, 0) & (position.pieces(Them, ROOK) | queens)) |
+                           (attacksFrom<BISHOP>(kingSquare, 0) & (position.pieces(Them, BISHOP) | queens));
+        while (snipers) {
+            int sniper = popLsb(snipers);
+            Bitboard blockers = BetweenTable[kingSquare][sniper] & occupied;
+            if (blockers && !(blockers & (blockers - 1)) && (blockers & position.pieces(Us))) {
+                pinned |= blockers;
+                pinLine[lsb(blockers)] = BetweenTable[kingSquare][sniper] | squareBB(sniper);
+            }
+        }
+    }
+
+    // Check if the pseudo-legal move keeps the king of color Us out of threat
+    bool isLegal(const Position& position, Move move) const {
+        if (kingSquare < 0) {
+            return true;
+        }
+        const int from = move.from();
+        const int to = move.to();
+        if (move.type() == CASTLING) {
+            // The king may not castle out of, through or into check
+            return !checkers && !(kingDanger & (BetweenTable[from][to] | squareBB(to)));
+        }
+        if (move.type() == EN_PASSANT) {
+            // Two pawns leave the row at once, which may uncover a slider, so play the move out
+            Position after = position;
+            after.makeMove(move);
+            return !isAttackedBy<Them>(after, kingSquare);
+        }
+        if (from == kingSquare) {
+            return !(kingDanger & squareBB(to));
+        }
+        if (checkers) {
+            if (checkers & (checkers - 1)) {
+                return false; // Double check, only the king can move
+            }
+            Bitboard evasions = checkers;
+            const int checker = lsb(checkers);
+            const PieceType checkerType = position.pieceTypeOn(checker);
+            if (checkerType == BISHOP || checkerType == ROOK || checkerType == QUEEN) {
+                evasions |= BetweenTable[kingSquare][checker];
+            }
+            if (!(evasions & squareBB(to))) {
+                return false;
+            }
+        }
+        return !(pinned & squareBB(from)) || (pinLine[from] & squareBB(to));
+    }
+};
+
+/* The function decides for each of count candidate moves of color Us whether ChessBoard::movePiece
+would accept it without leaving the mover's king under threat. Only the from and to squares of a
+candidate matter; its type is inferred with moveFor(). Checkers, pins, attacked squares and the
+pseudo-legal targets of each square are computed once for the position, so each candidate costs
+only a few bitboard operations. */
+template <PieceColor Us>
+void checkMovesLegal(const Position& position, const Move* moves, std::size_t count, std::vector<bool>& legal) {
+    const LegalityInfo<Us> info(position);
+    MoveList pseudoLegal;
+    generateMoves<Us>(position, pseudoLegal);
+    Bitboard targets[SQUARE_NB] = {};
+    for (const Move move : pseudoLegal) {
+        targets[move.from()] |= squareBB(move.to());
+    }
+    legal.assign(count, false);
+    for (std::size_t i = 0; i < count; ++i) {
+        const int from = moves[i].from();
+        const int to = moves[i].to();
+        legal[i] = (targets[from] & squareBB(to)) && info.isLegal(position, moveFor(position, from, to));
+    }
+}
+
+// Material value of each piece type in centipawns, indexed by PieceType (NO_PIECE_TYPE is worth 0)
+constexpr int PieceValue[PIECE_TYPE_NB + 1] = {100, 320, 330, 500, 900, 20000, 0};
+
+/* The function resolves the full sequence of captures on the destination of move that starts with
+move itself, and returns the material balance for the side making the first capture. Each side
+recaptures with its least valuable attacker and may stop when continuing would lose material. Sliders
+lined up behind a capturing piece join in once it has left the line. A capture en passant takes the
+pawn beside the destination, and a promotion gains the promoted piece, which is then the one at
+stake. Pins are not taken into account. */
+template <PieceColor Us>
+int staticExchange(const Position& position, Move move) {
+    constexpr int forward = (Us == PieceColor::RED) ? 8 : -8;
+    const int from = move.from();
+    const int to = move.to();
+    const Bitboard diagonalSliders = position.byType[BISHOP] | position.byType[QUEEN];
+    const Bitboard orthogonalSliders = position.byType[ROOK] | position.byType[QUEEN];
+
+    int gain[32];
+    int depth = 0;
+    gain[0] = PieceValue[position.pieceTypeOn(to)];
+    PieceType attacker = position.pieceTypeOn(from);
+    PieceColor side = Us;
+    Bitboard occupied = position.occupied() ^ squareBB(from);
+    if (move.type() == EN_PASSANT) {
+        gain[0] = PieceValue[PAWN];
+        occupied ^= squareBB(to - forward);
+    } else if (move.type() == PROMOTION) {
+        gain[0] += PieceValue[move.promotion()] - PieceValue[PAWN];
+        attacker = move.promotion();
+    }
+    Bitboard attackers = attackersTo<PieceColor::RED>(position, to, occupied) |
+                         attackersTo<PieceColor::BLUE>(position, to, occupied);
+
+    while (true) {
+        ++depth;
+        side = opponentOf(side);
+        // Value of the sequence if the piece just moved to 'to' is taken in turn
+        gain[depth] = PieceValue[attacker] - gain[depth - 1];
+        if (std::max(-gain[depth - 1], gain[depth]) < 0 || depth == 31) {
+            break; // Neither side can improve by continuing
+        }
+
+        // Reveal sliders behind the piece that just captured
+        attackers |= ((attacksFrom<BISHOP>(to, occupied) & diagonalSliders) |
+                      (attacksFrom<ROOK>(to, occupied) & orthogonalSliders));
+        attackers &= occupied;
+
+        Bitboard ours = attackers & position.pieces(side);
+        if (!ours) {
+            break;
+        }
+        // The least valuable attacker captures next; a king may not capture into a defended square
+        PieceType next = PAWN;
+        while (!(ours & position.byType[next])) {
+            next = static_cast<PieceType>(next + 1);
+        }
+        if (next == KING && (attackers & position.pieces(opponentOf(side)))) {
+            break;
+        }
+        occupied ^= squareBB(lsb(ours & position.byType[next]));
+        attacker = next;
+    }
+
+    // Negamax the gains back to the first capture
+    while (--depth) {
+        gain[depth - 1] = -std::max(-gain[depth - 1], gain[depth]);
+    }
+    return gain[0];
+}
+
+/* The code below evaluates positions. Pawn-structure terms only change when a pawn moves or is
+captured, so they are cached in a PawnHashTable keyed by Position::pawnKey. Each search thread owns
+its own table, so probes need no locking. */
+
+constexpr Bitboard ColABB = 0x0101010101010101ULL;
+
+// Build the masks of the squares in front of each square on its file (Span false) or on its file
+// and both neighbouring files (Span true), as seen by color Us
+template <PieceColor Us, bool Span>
+constexpr SquareTable makeFrontTable() {
+    constexpr int forward = (Us == PieceColor::RED) ? 1 : -1;
+    SquareTable table{};
+    for (int square = 0; square < SQUARE_NB; ++square) {
+        for (int row = rowOf(square) + forward; row >= 0 && row < 8; row += forward) {
+            for (int col = colOf(square) - Span; col <= colOf(square) + Span; ++col) {
+                if (isOnBoard(row, col)) {
+                    table[square] |= squareBB(squareOf(row, col));
+                }
+            }
+        }
+    }
+    return table;
+}
+
+inline constexpr std::array<SquareTable, COLOR_NB> ForwardFileTable = {
+    makeFrontTable<PieceColor::RED, false>(), makeFrontTable<PieceColor::BLUE, false>()};
+inline constexpr std::array<SquareTable, COLOR_NB> PassedPawnTable = {
+    makeFrontTable<PieceColor::RED, true>(), makeFrontTable<PieceColor::BLUE, true>()};
+
+constexpr Bitboard adjacentFiles(int col) {
+    return ((col > 0) ? (ColABB << (col - 1)) : 0) | ((col < 7) ? (ColABB << (col + 1)) : 0);
+}
+
+// Row of square counted from the starting side of color Us
+template <PieceColor Us>
+constexpr int relativeRow(int square) {
+    return Us == PieceColor::RED ? rowOf(square) : 7 - rowOf(square);
+}
+
+constexpr int DoubledPenalty = 12;
+constexpr int IsolatedPenalty = 15;
+constexpr int BackwardPenalty = 10;
+constexpr int PassedBonus[8] = {0, 5, 10, 20, 35, 60, 100, 0};
+constexpr int ShelterBonus[3] = {-20, 12, 6}; // No pawn, pawn one row ahead, pawn two rows ahead
+
+/* The PawnEntry struct caches the pawn-structure evaluation of one pawn configuration. Scores are
+from RED's point of view. The shelter of each king is computed lazily for the king square it was
+last asked for. A zero-initialised entry is the correct entry for a board without pawns, whose
+pawn key is 0. */
+struct PawnEntry {
+    Key key = 0;
+    int score = 0;
+    std::array<Bitboard, COLOR_NB> passed{};
+    std::array<int, COLOR_NB> kingSquare = {-1, -1};
+    std::array<int, COLOR_NB> shelter{};
+};
+
+// Evaluate the pawns of color Us, recording its passed pawns in entry
+template <PieceColor Us>
+int evaluatePawns(const Position& position, PawnEntry& entry) {
+    constexpr PieceColor Them = opponentOf(Us);
+    constexpr int forward = (Us == PieceColor::RED) ? 8 : -8;
+    const Bitboard ours = position.pieces(Us, PAWN);
+    const Bitboard theirs = position.pieces(Them, PAWN);
+    const Bitboard theirCaptures = pawnCaptureSquares<Them>(theirs);
+
+    int score = 0;
+    entry.passed[colorIndex(Us)] = 0;
+    Bitboard pawns = ours;
+    while (pawns) {
+        int square = popLsb(pawns);
+        Bitboard neighbours = ours & adjacentFiles(colOf(square));
+        if (ForwardFileTable[colorIndex(Us)][square] & ours) {
+            score -= DoubledPenalty;
+        }
+        if (!neighbours) {
+            score -= IsolatedPenalty;
+        } else if (!(neighbours & ~PassedPawnTable[colorIndex(Us)][square]) && relativeRow<Us>(square) < 6 &&
+                   (theirCaptures & squareBB(square + forward))) {
+            // Every neighbour is already ahead, so none can support the pawn, and its stop square is taken
+            score -= BackwardPenalty;
+        }
+        if (!(PassedPawnTable[colorIndex(Us)][square] & theirs)) {
+            entry.passed[colorIndex(Us)] |= squareBB(square);
+            score += PassedBonus[relativeRow<Us>(square)];
+        }
+    }
+    return score;
+}
+
+// Score the pawns in front of the king of color Us on the king's file and both neighbouring files
+template <PieceColor Us>
+int evaluateShelter(const Position& position, int kingSquare) {
+    const Bitboard ours = position.pieces(Us, PAWN);
+    int score = 0;
+    for (int col = std::max(0, colOf(kingSquare) - 1); col <= std::min(7, colOf(kingSquare) + 1); ++col) {
+        Bitboard front = ours & ForwardFileTable[colorIndex(Us)][squareOf(rowOf(kingSquare), col)];
+        int distance = 0;
+        if (front) {
+            int nearest = (Us == PieceColor::RED) ? lsb(front) : msb(front);
+            distance = std::abs(rowOf(nearest) - rowOf(kingSquare));
+        }
+        score += ShelterBonus[distance <= 2 ? distance : 0];
+    }
+    return score;
+}
+
+/**
+ * The PawnHashTable class caches PawnEntry values by pawn key and counts its hits.
+ */
+class PawnHashTable {
+public:
+    // The number of entries is rounded down to a power of two
+    explicit PawnHashTable(std::size_t entries = 16384) {
+        std::size_t size = 1;
+        while (size * 2 <= entries) {
+            size *= 2;
+        }
+        table.resize(size);
+    }
+
+    PawnEntry& probe(const Position& position) {
+        PawnEntry& entry = table[position.pawnKey & (table.size() - 1)];
+        ++probeCount;
+        if (entry.key == position.pawnKey) {
+            ++hitCount;
+            return entry;
+        }
+        entry = PawnEntry();
+        entry.key = position.pawnKey;
+        entry.score = evaluatePawns<PieceColor::RED>(position, entry) - evaluatePawns<PieceColor::BLUE>(position, entry);
+        return entry;
+    }
+
+    std::uint64_t probes() const {
+        return probeCount;
+    }
+
+    std::uint64_t hits() const {
+        return hitCount;
+    }
+
+    double hitRate() const {
+        return probeCount ? static_cast<double>(hitCount) / probeCount : 0.0;
+    }
+
+private:
+    std::vector<PawnEntry> table;
+    std::uint64_t probeCount = 0;
+    std::uint64_t hitCount = 0;
+};
+
+/* The function scores the passed pawns of color Us with no piece of either color in front of them.
+It depends on every piece, so it is added to the cached passed-pawn score at each evaluation. */
+template <PieceColor Us>
+int evaluateFreePassers(const Position& position, Bitboard passed) {
+    const Bitboard occupied = position.occupied();
+    int score = 0;
+    while (passed) {
+        const int square = popLsb(passed);
+        if (!(ForwardFileTable[colorIndex(Us)][square] & occupied)) {
+            score += PassedBonus[relativeRow<Us>(square)] / 2;
+        }
+    }
+    return score;
+}
+
+/* The function returns the static evaluation of position in centipawns from the point of view of
+sideToMove: material, the cached pawn structure, passed pawns with a free path and the pawn shelter
+of both kings. */
+inline int evaluate(const Position& position, PieceColor sideToMove, PawnHashTable& pawnTable) {
+    int score = 0;
+    for (int type = PAWN; type < KING; ++type) {
+        score += PieceValue[type] * (popCount(position.pieces(PieceColor::RED, static_cast<PieceType>(type))) -
+                                     popCount(position.pieces(PieceColor::BLUE, static_cast<PieceType>(type))));
+    }
+
+    PawnEntry& entry = pawnTable.probe(position);
+    score += entry.score;
+    score += evaluateFreePassers<PieceColor::RED>(position, entry.passed[0]) -
+             evaluateFreePassers<PieceColor::BLUE>(position, entry.passed[1]);
+    const int kings[COLOR_NB] = {position.kingSquare(PieceColor::RED), position.kingSquare(PieceColor::BLUE)};
+    for (int color = 0; color < COLOR_NB; ++color) {
+        if (kings[color] >= 0 && entry.kingSquare[color] != kings[color]) {
+            entry.kingSquare[color] = kings[color];
+            entry.shelter[color] = color == 0 ? evaluateShelter<PieceColor::RED>(position, kings[color])
+                                              : evaluateShelter<PieceColor::BLUE>(position, kings[color]);
+        }
+    }
+    if (kings[0] >= 0) {
+        score += entry.shelter[0];
+    }
+    if (kings[1] >= 0) {
+        score -= entry.shelter[1];
+    }
+    return sideToMove == PieceColor::RED ? score : -score;
+}
+
+/* The function appends the moves of color Us that do not leave its king under threat, or only the
+captures and queen promotions among them when CapturesOnly is set. */
+template <PieceColor Us, bool CapturesOnly = false>
+void generateLegalMoves(const Position& position, MoveList& moves) {
+    const LegalityInfo<Us> info(position);
+    const std::size_t first = moves.size();
+    generateMoves<Us>(position, moves);
+    std::size_t kept = first;
+    for (std::size_t i = first; i < moves.size(); ++i) {
+        const Move move = moves[i];
+        if (CapturesOnly && !position.isCapture(move) &&
+            !(move.type() == PROMOTION && move.promotion() == QUEEN)) {
+            continue;
+        }
+        if (info.isLegal(position, move)) {
+            moves[kept++] = move;
+        }
+    }
+    moves.resize(kept);
+}
+
+// Check if the king of color Us is under threat
+template <PieceColor Us>
+bool isInCheck(const Position& position) {
+    const int king = position.kingSquare(Us);
+    return king >= 0 && isAttackedBy<opponentOf(Us)>(position, king);
+}
+
+/* The function checks if move is a legal move of color Us in position, for moves read from untrusted
+input. Only the moves of the piece type standing on the origin square are generated, and the move
+is played out on a copy to see if it leaves the king under threat. */
+template <PieceColor Us>
+bool isLegalMove(const Position& position, Move move) {
+    if (!(position.pieces(Us) & squareBB(move.from()))) {
+        return false;
+    }
+    MoveList moves;
+    switch (position.pieceTypeOn(move.from())) {
+    case PAWN:
+        generatePawnMoves<Us>(position, moves);
+        break;
+    case KNIGHT:
+        generatePieceMoves<Us, KNIGHT>(position, moves);
+        break;
+    case BISHOP:
+        generatePieceMoves<Us, BISHOP>(position, moves);
+        break;
+    case ROOK:
+        generatePieceMoves<Us, ROOK>(position, moves);
+        break;
+    case QUEEN:
+        generatePieceMoves<Us, QUEEN>(position, moves);
+        break;
+    default:
+        generatePieceMoves<Us, KING>(position, moves);
+        generateCastlingMoves<Us>(position, moves);
+        break;
+    }
+    if (!moves.contains(move)) {
+        return false;
+    }
+    if (move.type() == CASTLING) {
+        return LegalityInfo<Us>(position).isLegal(position, move);
+    }
+    Position after = position;
+    after.makeMove(move);
+    return !isInCheck<Us>(after);
+}
+
+inline bool isLegalMove(const Position& position, PieceColor sideToMove, Move move) {
+    return sideToMove == PieceColor::RED ? isLegalMove<PieceColor::RED>(position, move)
+                                         : isLegalMove<PieceColor::BLUE>(position, move);
+}
+
+/**
+ * The function counts the leaf nodes of the legal move tree of color Us to the given depth, making
+ * and unmaking each move in place. The count is the standard perft number of the position.
+ */
+template <PieceColor Us>
+std::uint64_t perft(Position& position, int depth) {
+    MoveList moves;
+    generateLegalMoves<Us>(position, moves);
+    if (depth <= 1) {
+        return depth == 1 ? moves.size() : 1;
+    }
+    std::uint64_t nodes = 0;
+    UndoInfo undo;
+    for (const Move move : moves) {
+        position.makeMove(move, undo);
+        nodes += perft<opponentOf(Us)>(position, depth - 1);
+        position.unmakeMove(move, undo);
+    }
+    return nodes;
+}
+
+/* The code below implements an alpha-beta search with selective extensions and pruning. Every
+feature can be switched off and tuned through SearchParams, so its effect on node counts and time
+to depth can be measured in isolation (see the search-bench command). */
+constexpr int MaxPly = 64;
+constexpr int MateScore = 30000;
+constexpr int InfiniteScore = 32000;
+
+// Tunable parameters and enable switches of the selective search features
+struct SearchParams {
+    // Null-move pruning: skip a turn and search with reduced depth; not done in check or when the side
+    // to move has only pawns and king left, where passing may be better than any move (zugzwang)
+    bool nullMove = true;
+    int nullMoveMinDepth = 3;
+    int nullMoveReduction = 3;
+
+    // Late-move reductions: quiet moves late in the move order are searched with reduced depth,
+    // reduced by one ply less when their history score is positive
+    bool lateMoveReductions = true;
+    int lmrMinDepth = 3;
+    int lmrFullDepthMoves = 3;
+
+    // Futility pruning: near the leaves skip quiet moves that cannot raise the score above alpha
+    bool futility = true;
+    int futilityDepth = 3;
+    int futilityMargin = 120;
+
+    // Reverse futility pruning: near the leaves return when the static score beats beta by a margin
+    bool reverseFutility = true;
+    int reverseFutilityDepth = 3;
+    int reverseFutilityMargin = 120;
+
+    // Check extensions: search moves that give check one ply deeper
+    bool checkExtensions = true;
+
+    // Transposition table: reuse scores and best moves of positions already searched
+    bool transpositionTable = true;
+    std::size_t hashEntries = 1 << 18;
+};
+
+// The result of a search
+struct SearchResult {
+    Move bestMove;
+    int score = 0;
+    int depth = 0;
+    std::uint64_t nodes = 0;
+    double seconds = 0.0;
+};
+
+// One candidate line of a multi-PV analysis: the root move, its score and the expected continuation
+struct AnalysisLine {
+    Move move;
+    int score = 0;
+    std::vector<Move> pv;
+};
+
+// The result of a multi-PV analysis after one iteration, with the best lines first
+struct AnalysisResult {
+    std::vector<AnalysisLine> lines;
+    int depth = 0;
+    std::uint64_t nodes = 0;
+    double seconds = 0.0;
+    // Set when the side to move has no legal moves and is in check, so there are no lines
+    bool checkmate = false;
+    // Set when the side to move has no legal moves and is not in check
+    bool stalemate = false;
+};
+
+// The kind of score stored in a transposition table entry
+enum class Bound : std::uint8_t { NONE, UPPER, LOWER, EXACT };
+
+/* The TTEntry struct stores the result of searching one position. Mate scores are stored relative
+to the position, not the root, so an entry stays valid when the position is reached at another ply. */
+struct TTEntry {
+    Key key = 0;
+    std::int16_t score = 0;
+    std::int8_t depth = 0;
+    Bound bound = Bound::NONE;
+    std::uint16_t bestMove = 0;
+
+    Move move() const {
+        return Move::fromRaw(bestMove);
+    }
+};
+
+/**
+ * The TranspositionTable class caches search results by position key. An entry is replaced by
+ * results of other positions and by results of at least the same depth.
+ */
+class TranspositionTable {
+public:
+    // The number of entries is rounded down to a power of two
+    explicit TranspositionTable(std::size_t entries = 1 << 18) {
+        std::size_t size = 1;
+        while (size * 2 <= entries) {
+            size *= 2;
+        }
+        table.resize(size);
+    }
+
+    const TTEntry* probe(Key key) const {
+        const TTEntry& entry = table[key & (table.size() - 1)];
+        return entry.key == key && entry.bound != Bound::NONE ? &entry : nullptr;
+    }
+
+    void store(Key key, int depth, int score, int ply, Bound bound, Move move) {
+        TTEntry& entry = table[key & (table.size() - 1)];
+        if (entry.key == key && depth < entry.depth) {
+            return;
+        }
+        if (score >= MateScore - MaxPly) {
+            score += ply;
+        } else if (score <= -MateScore + MaxPly) {
+            score -= ply;
+        }
+        entry.key = key;
+        entry.score = static_cast<std::int16_t>(score);
+        entry.depth = static_cast<std::int8_t>(depth);
+        entry.bound = bound;
+        entry.bestMove = move.raw();
+    }
+
+    // Score of entry as seen from ply plies below the root
+    static int score(const TTEntry& entry, int ply) {
+        if (entry.score >= MateScore - MaxPly) {
+            return entry.score - ply;
+        }
+        if (entry.score <= -MateScore + MaxPly) {
+            return entry.score + ply;
+        }
+        return entry.score;
+    }
+
+    void clear() {
+        std::fill(table.begin(), table.end(), TTEntry());
+    }
+
+private:
+    std::vector<TTEntry> table;
+};
+
+/**
+ * The Searcher class searches positions with iterative deepening. It owns its move ordering tables,
+ * transposition table and pawn hash table, so each thread should use its own Searcher.
+ */
+class Searcher {
+public:
+    explicit Searcher(const SearchParams& searchParams = SearchParams())
+        : params(searchParams), hashTable(searchParams.transpositionTable ? searchParams.hashEntries : 1) {
+        clearHistory();
+    }
+
+    SearchResult search(const Position& position, PieceColor sideToMove, int depth);
+
+    AnalysisResult analyze(const Position& position, PieceColor sideToMove, int depth, int lineCount,
+                           const std::function<void(const AnalysisResult&)>& onIteration = nullptr);
+
+    // Forget everything learnt from earlier searches
+    void clear() {
+        clearHistory();
+        hashTable.clear();
+    }
+
+    void clearHistory() {
+        for (auto& byFrom : history) {
+            for (auto& byTo : byFrom) {
+                byTo.fill(0);
+            }
+        }
+        for (auto& killer : killers) {
+            killer.fill(Move());
+        }
+    }
+
+    const PawnHashTable& pawnTable() const {
+        return pawns;
+    }
+
+private:
+    // A root move of the analysis with its latest score, which is exact if it was in the best lines
+    struct RootMove {
+        Move move;
+        int score;
+        bool exact;
+    };
+
+    SearchParams params;
+    TranspositionTable hashTable;
+    PawnHashTable pawns;
+    std::uint64_t nodes = 0;
+    std::array<std::array<std::array<int, SQUARE_NB>, SQUARE_NB>, COLOR_NB> history;
+    std::array<std::array<Move, 2>, MaxPly + 1> killers;
+    std::array<MoveList, MaxPly + 1> moveStack;
+    std::array<std::array<int, MoveList::Capacity>, MaxPly + 1> scoreStack;
+
+    template <PieceColor Us>
+    int negamax(const Position& position, int depth, int ply, int alpha, int beta, bool allowNull);
+
+    template <PieceColor Us>
+    int quiescence(const Position& position, int ply, int alpha, int beta);
+
+    template <PieceColor Us>
+    void scoreMoves(const Position& position, int ply, Move hashMove);
+
+    template <PieceColor Us>
+    void searchRoot(const Position& position, std::vector<RootMove>& rootMoves, int depth, std::size_t lineCount);
+
+    std::vector<Move> principalVariation(const Position& position, PieceColor sideToMove, Move first, int depth) const;
+
+    // Move the best scored of the remaining moves at ply to index
+    void pickMove(int ply, std::size_t index) {
+        MoveList& moves = moveStack[ply];
+        std::array<int, MoveList::Capacity>& scores = scoreStack[ply];
+        std::size_t best = index;
+        for (std::size_t i = index + 1; i < moves.size(); ++i) {
+            if (scores[i] > scores[best]) {
+                best = i;
+            }
+        }
+        std::swap(moves[index], moves[best]);
+        std::swap(scores[index], scores[best]);
+    }
+
+    bool isKiller(int ply, Move move) const {
+        return killers[ply][0] == move || killers[ply][1] == move;
+    }
+};
+
+/* Order moves: the hash move first, then winning and equal captures by victim value and static
+exchange, queen promotions, killer moves, quiet moves by history, losing captures and finally
+underpromotions. */
+template <PieceColor Us>
+void Searcher::scoreMoves(const Position& position, int ply, Move hashMove) {
+    const MoveList& moves = moveStack[ply];
+    std::array<int, MoveList::Capacity>& scores = scoreStack[ply];
+    for (std::size_t i = 0; i < moves.size(); ++i) {
+        const Move move = moves[i];
+        if (move == hashMove) {
+            scores[i] = 4000000;
+        } else if (position.isCapture(move)) {
+            int see = staticExchange<Us>(position, move);
+            int victim = move.type() == EN_PASSANT ? PieceValue[PAWN] : PieceValue[position.pieceTypeOn(move.to())];
+            scores[i] = see >= 0 ? 3000000 + victim * 8 - PieceValue[position.pieceTypeOn(move.from())] / 100
+                                 : -1000000 + see;
+        } else if (move.type() == PROMOTION) {
+            scores[i] = move.promotion() == QUEEN ? 3000000 : -2000000;
+        } else if (isKiller(ply, move)) {
+            scores[i] = 2000000;
+        } else {
+            scores[i] = history[colorIndex(Us)][move.from()][move.to()];
+        }
+    }
+}
+
+template <PieceColor Us>
+int Searcher::quiescence(const Position& position, int ply, int alpha, int beta) {
+    constexpr PieceColor Them = opponentOf(Us);
+    ++nodes;
+    if (position.kingSquare(Us) < 0) {
+        return -MateScore + ply;
+    }
+    int standPat = evaluate(position, Us, pawns);
+    if (standPat >= beta || ply >= MaxPly) {
+        return standPat;
+    }
+    alpha = std::max(alpha, standPat);
+
+    MoveList& moves = moveStack[ply];
+    moves.clear();
+    generateLegalMoves<Us, true>(position, moves);
+    scoreMoves<Us>(position, ply, Move());
+    for (std::size_t i = 0; i < moves.size(); ++i) {
+        pickMove(ply, i);
+        if (scoreStack[ply][i] < 0) {
+            break; // Only losing captures are left
+        }
+        Position next = position;
+        next.makeMove(moves[i]);
+        int score = -quiescence<Them>(next, ply + 1, -beta, -alpha);
+        if (score >= beta) {
+            return score;
+        }
+        alpha = std::max(alpha, score);
+    }
+    return alpha;
+}
+
+template <PieceColor Us>
+int Searcher::negamax(const Position& position, int depth, int ply, int alpha, int beta, bool allowNull) {
+    constexpr PieceColor Them = opponentOf(Us);
+    if (position.kingSquare(Us) < 0) {
+        return -MateScore + ply;
+    }
+    if (depth <= 0 || ply >= MaxPly) {
+        return quiescence<Us>(position, ply, alpha, beta);
+    }
+    ++nodes;
+
+    const bool pvNode = beta - alpha > 1;
+    const Key key = positionKey(position, Us);
+    Move hashMove;
+    if (params.transpositionTable) {
+        if (const TTEntry* entry = hashTable.probe(key)) {
+            hashMove = entry->move();
+            const int score = TranspositionTable::score(*entry, ply);
+            if (!pvNode && entry->depth >= depth &&
+                (entry->bound == Bound::EXACT || (entry->bound == Bound::LOWER && score >= beta) ||
+                 (entry->bound == Bound::UPPER && score <= alpha))) {
+                return score;
+            }
+        }
+    }
+
+    const bool inCheck = isInCheck<Us>(position);
+    const int originalAlpha = alpha;
+    const int staticEval = inCheck ? -InfiniteScore : evaluate(position, Us, pawns);
+
+    if (!inCheck && !pvNode) {
+        if (params.reverseFutility && depth <= params.reverseFutilityDepth &&
+            staticEval - params.reverseFutilityMargin * depth >= beta) {
+            return staticEval;
+        }
+        const Bitboard nonPawnMaterial = position.pieces(Us) & ~position.byType[PAWN] & ~position.byType[KING];
+        if (params.nullMove && allowNull && depth >= params.nullMoveMinDepth && staticEval >= beta &&
+            nonPawnMaterial) {
+            int reduction = params.nullMoveReduction + depth / 6;
+            // Passing gives up the right to take en passant
+            Position passed = position;
+            passed.setEnPassant(-1);
+            int score = -negamax<Them>(passed, depth - 1 - reduction, ply + 1, -beta, -beta + 1, false);
+            if (score >= beta) {
+                return score >= MateScore - MaxPly ? beta : score;
+            }
+        }
+    }
+
+    MoveList& moves = moveStack[ply];
+    moves.clear();
+    generateLegalMoves<Us>(position, moves);
+    if (moves.empty()) {
+        return inCheck ? -MateScore + ply : 0;
+    }
+    scoreMoves<Us>(position, ply, hashMove);
+
+    const bool canPruneQuiets = params.futility && !inCheck && !pvNode && depth <= params.futilityDepth &&
+                                staticEval + params.futilityMargin * depth <= alpha;
+    int bestScore = -InfiniteScore;
+    Move bestMove;
+    int movesSearched = 0;
+    for (std::size_t i = 0; i < moveStack[ply].size(); ++i) {
+        pickMove(ply, i);
+        const Move move = moveStack[ply][i];
+        const bool capture = position.isCapture(move);
+        Position next = position;
+        next.makeMove(move);
+        const bool givesCheck = isInCheck<Them>(next);
+
+        if (canPruneQuiets && !capture && move.type() != PROMOTION && !givesCheck && movesSearched > 0) {
+            continue;
+        }
+
+        int extension = (params.checkExtensions && givesCheck) ? 1 : 0;
+        int newDepth = depth - 1 + extension;
+        int score;
+        if (movesSearched == 0) {
+            score = -negamax<Them>(next, newDepth, ply + 1, -beta, -alpha, true);
+        } else {
+            int reduction = 0;
+            if (params.lateMoveReductions && depth >= params.lmrMinDepth && movesSearched >= params.lmrFullDepthMoves &&
+                !capture && !givesCheck && !inCheck && !isKiller(ply, move)) {
+                reduction = 1 + (movesSearched >= params.lmrFullDepthMoves + 6) + (depth >= 8);
+                if (history[colorIndex(Us)][move.from()][move.to()] > 0) {
+                    --reduction;
+                }
+                reduction = std::max(0, std::min(reduction, newDepth - 1));
+            }
+            score = -negamax<Them>(next, newDepth - reduction, ply + 1, -alpha - 1, -alpha, true);
+            if (score > alpha && reduction > 0) {
+                score = -negamax<Them>(next, newDepth, ply + 1, -alpha - 1, -alpha, true);
+            }
+            if (score > alpha && score < beta) {
+                score = -negamax<Them>(next, newDepth, ply + 1, -beta, -alpha, true);
+            }
+        }
+        ++movesSearched;
+
+        if (score > bestScore) {
+            bestScore = score;
+            bestMove = move;
+            if (score > alpha) {
+                alpha = score;
+                if (score >= beta) {
+                    if (!capture) {
+                        killers[ply][1] = killers[ply][0];
+                        killers[ply][0] = move;
+                        int& entry = history[colorIndex(Us)][move.from()][move.to()];
+                        entry = std::min(entry + depth * depth, 1 << 20);
+                    }
+                    break;
+                }
+            }
+        } else if (!capture) {
+            history[colorIndex(Us)][move.from()][move.to()] -= depth;
+        }
+    }
+    if (!movesSearched) {
+        return alpha;
+    }
+    if (params.transpositionTable) {
+        const Bound bound = bestScore >= beta ? Bound::LOWER : bestScore > originalAlpha ? Bound::EXACT : Bound::UPPER;
+        hashTable.store(key, depth, bestScore, ply, bound, bestMove);
+    }
+    return bestScore;
+}
+
+/* Search every root move for a depth and keep the moves sorted best first. The best lineCount moves
+get exact scores: each later move is searched with the score of the current last of the best lines
+as lower bound, so a move that cannot enter the best lines is refuted as cheaply as in a
+single-line search, while the transposition table and the move ordering tables are shared by all
+lines. */
+template <PieceColor Us>
+void Searcher::searchRoot(const Position& position, std::vector<RootMove>& rootMoves, int depth, std::size_t lineCount) {
+    std::vector<int> best; // Exact scores of this iteration, best first
+    for (RootMove& rootMove : rootMoves) {
+        const int alpha = best.size() < lineCount ? -InfiniteScore : best[lineCount - 1];
+        Position next = position;
+        next.makeMove(rootMove.move);
+        ++nodes;
+        rootMove.score = -negamax<opponentOf(Us)>(next, depth - 1, 1, -InfiniteScore, -alpha, true);
+        rootMove.exact = rootMove.score > alpha;
+        if (rootMove.exact) {
+            best.insert(std::upper_bound(best.begin(), best.end(), rootMove.score, std::greater<int>()), rootMove.score);
+        }
+    }
+    std::stable_sort(rootMoves.begin(), rootMoves.end(), [](const RootMove& a, const RootMove& b) {
+        return a.score > b.score || (a.score == b.score && a.exact && !b.exact);
+    });
+}
+
+// Follow the best moves stored in the transposition table from the position after the root move first
+std::vector<Move> Searcher::principalVariation(const Position& position, PieceColor sideToMove, Move first,
+                                               int depth) const {
+    std::vector<Move> pv = {first};
+    Position current = position;
+    current.makeMove(first);
+    PieceColor side = opponentOf(sideToMove);
+    MoveList legalMoves;
+    while (static_cast<int>(pv.size()) < depth && params.transpositionTable) {
+        const TTEntry* entry = hashTable.probe(positionKey(current, side));
+        if (!entry) {
+            break;
+        }
+        const Move move = entry->move();
+        legalMoves.clear();
+        if (side == PieceColor::RED) {
+            generateLegalMoves<PieceColor::RED>(current, legalMoves);
+        } else {
+            generateLegalMoves<PieceColor::BLUE>(current, legalMoves);
+        }
+        // Stored moves may belong to another position with the same index bits, so check them
+        if (!legalMoves.contains(move)) {
+            break;
+        }
+        pv.push_back(move);
+        current.makeMove(move);
+        side = opponentOf(side);
+    }
+    return pv;
+}
+
+/**
+ * The function analyzes position with iterative deepening up to depth plies and returns the best
+ * lineCount root moves with their scores from the point of view of sideToMove and their principal
+ * variations.
+ *
+ * @param onIteration Called with the lines found after each completed depth, if set.
+ */
+AnalysisResult Searcher::analyze(const Position& position, PieceColor sideToMove, int depth, int lineCount,
+                                 const std::function<void(const AnalysisResult&)>& onIteration) {
+    AnalysisResult result;
+    nodes = 0;
+    auto start = std::chrono::steady_clock::now();
+    MoveList moves;
+    if (sideToMove == PieceColor::RED) {
+        generateLegalMoves<PieceColor::RED>(position, moves);
+    } else {
+        generateLegalMoves<PieceColor::BLUE>(position, moves);
+    }
+    if (moves.empty()) {
+        const bool inCheck = sideToMove == PieceColor::RED ? isInCheck<PieceColor::RED>(position)
+                                                           : isInCheck<PieceColor::BLUE>(position);
+        result.checkmate = inCheck;
+        result.stalemate = !inCheck;
+        return result;
+    }
+    std::vector<RootMove> rootMoves;
+    for (const Move move : moves) {
+        rootMoves.push_back({move, -InfiniteScore, false});
+    }
+    const std::size_t lines = std::min(rootMoves.size(), static_cast<std::size_t>(std::max(lineCount, 1)));
+
+    for (int iteration = 1; iteration <= std::min(depth, MaxPly - 1) && !rootMoves.empty(); ++iteration) {
+        if (sideToMove == PieceColor::RED) {
+            searchRoot<PieceColor::RED>(position, rootMoves, iteration, lines);
+        } else {
+            searchRoot<PieceColor::BLUE>(position, rootMoves, iteration, lines);
+        }
+        result.lines.clear();
+        for (std::size_t i = 0; i < lines; ++i) {
+            result.lines.push_back({rootMoves[i].move, rootMoves[i].score,
+                                    principalVariation(position, sideToMove, rootMoves[i].move, iteration)});
+        }
+        result.depth = iteration;
+        result.nodes = nodes;
+        result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        if (onIteration) {
+            onIteration(result);
+        }
+    }
+    return result;
+}
+
+/**
+ * The function searches position with iterative deepening up to depth plies and returns the best
+ * move found with its score from the point of view of sideToMove.
+ */
+SearchResult Searcher::search(const Position& position, PieceColor sideToMove, int depth) {
+    AnalysisResult analysis = analyze(position, sideToMove, depth, 1);
+    SearchResult result;
+    if (!analysis.lines.empty()) {
+        result.bestMove = analysis.lines[0].move;
+        result.score = analysis.lines[0].score;
+    }
+    result.depth = analysis.depth;
+    result.nodes = analysis.nodes;
+    result.seconds = analysis.seconds;
+    return result;
+}
+
+/**
+ * The function analyzes many positions on a pool of threads, each with its own Searcher that is
+ * reused from one position to the next, and returns the results in the order of positions.
+ */
+std::vector<AnalysisResult> analyzePositions(const std::vector<Position>& positions, const std::vector<PieceColor>& sides,
+                                             int depth, int lineCount, unsigned threadCount,
+                                             const SearchParams& params = SearchParams()) {
+    std::vector<AnalysisResult> results(positions.size());
+    std::atomic<std::size_t> nextPosition(0);
+    auto work = [&]() {
+        Searcher searcher(params);
+        for (std::size_t i = nextPosition++; i < positions.size(); i = nextPosition++) {
+            searcher.clear();
+            results[i] = searcher.analyze(positions[i], sides[i], depth, lineCount);
+        }
+    };
+    threadCount = std::max(1u, std::min<unsigned>(threadCount, static_cast<unsigned>(positions.size())));
+    std::vector<std::thread> workers;
+    for (unsigned t = 1; t < threadCount; ++t) {
+        workers.emplace_back(work);
+    }
+    work();
+    for (std::thread& worker : workers) {
+        worker.join();
+    }
+    return results;
+}
+
+// Forward declaration of ChessPiece class
+class ChessPiece;
+
+/* The above class defines an interface for common chess piece behaviors. */
+// Interface for common chess piece behaviors
+class ChessPieceInterface {
+public:
+    virtual bool isValidMove(int rowFrom, int colFrom, int rowTo, int colTo) const = 0;
+    virtual char getSymbol() const = 0;
+    virtual PieceColor getColor() const = 0;
+    virtual ~ChessPieceInterface() = default;
+};
+
+// Class to represent the ChessBoard/* The ChessBoard class represents a chess board and provides
+//methods for moving pieces, checking for threats, and determining
+
+
+class ChessBoard {
+private:
+    std::vector<std::vector<ChessPiece*>> board;
+    bool gameOver;
+    bool quiet = false;
+    Position position;
+
+   // bool isPathClear(int rowFrom, int colFrom, int rowTo, int colTo) const;
+    void rebuildPosition(int castlingRights, int epSquare);
+
+public:
+    /* The above code is defining a class called ChessBoard. This class represents a chess board and
+    provides various methods for manipulating and checking the state of the board. */
+    ChessBoard();
+    ChessBoard(const ChessBoard& other);
+    explicit ChessBoard(const Position& setup);
+    ChessBoard& operator=(const ChessBoard&) = delete;
+    ~ChessBoard();
+
+    void display() const;
+    ChessPiece* getPiece(int row, int col) const;
+    const Position& getPosition() const;
+    int getCastlingRights() const;
+    int getEnPassantSquare() const;
+    std::vector<Move> generateMoves(PieceColor currentPlayer) const;
+    bool isSquareAttacked(int row, int col, PieceColor currentPlayer) const;
+    Bitboard attackedSquares(PieceColor attacker) const;
+    std::vector<bool> areMovesLegal(const std::vector<Move>& candidates, PieceColor currentPlayer) const;
+    int staticExchange(int rowFrom, int colFrom, int rowTo, int colTo) const;
+    bool movePiece(int rowFrom, int colFrom, int rowTo, int colTo, PieceType promotion = QUEEN);
+    bool movePiece(Move move);
+    bool isSquareUnderThreat(int row, int col, PieceColor currentPlayer) const;
+    bool isCheckmate(PieceColor currentPlayer) ;
+    bool canEscapeCheck(int kingRow, int kingCol, PieceColor currentPlayer) const;
+    bool isMovePuttingKingInCheck(int fromRow, int fromCol, int toRow, int toCol, PieceColor currentPlayer) const;
+    bool isPlayerKingCaptured(PieceColor playerColor) const;
+    bool isGameOver();
+    void setQuiet(bool value);
+};
+
+/* The above code defines a set of classes for different chess pieces, each inheriting from a base
+class, with each class implementing its own isValidMove() and getSymbol() functions. */
+// Base class for ChessPiece
+class ChessPiece : public ChessPieceInterface {
+protected:
+    PieceColor color;
+    ChessBoard* board; 
+    bool isPathClear(int rowFrom, int colFrom, int rowTo, int colTo) const;
+
+public:
+    ChessPiece(PieceColor pieceColor) : color(pieceColor), board(nullptr) {}
+
+    // Setter function for the chessboard
+    void setChessBoard(ChessBoard* chessBoard) {
+        board = chessBoard;
+    }
+    
+    PieceColor getColor() const override {
+        return color;
+    }
+
+    bool isValidMove(int rowFrom, int colFrom, int rowTo, int colTo) const override {
+        // Default implementation (can be overridden by derived classes)
+        return true;
+    }
+};
+
+/* The Pawn class is a derived class of ChessPiece and implements the isValidMove and getSymbol
+functions. */
+// Derived class for Pawn
+class Pawn : public ChessPiece {
+public:
+    using ChessPiece::ChessPiece;
+
+    bool isValidMove(int rowFrom, int colFrom, int rowTo, int colTo) const override;
+    char getSymbol() const override;
+};
+
+/* The Rook class is a derived class of ChessPiece and overrides the isValidMove and getSymbol
+functions. */
+// Derived class for Rook
+class Rook : public ChessPiece {
+public:
+    using ChessPiece::ChessPiece;
+
+    bool isValidMove(int rowFrom, int colFrom, int rowTo, int colTo) const override;
+    char getSymbol() const override;
+};
+
+/* The Knight class is a subclass of ChessPiece and overrides the isValidMove and getSymbol functions. */
+class Knight : public ChessPiece {
+public:
+    using ChessPiece::ChessPiece;
+    
+    bool isValidMove(int rowFrom, int colFrom, int rowTo, int colTo) const override;
+    char getSymbol() const override;
+     
+};
+
+/* The Bishop class is a subclass of ChessPiece and overrides the isValidMove and getSymbol functions. */
+class Bishop : public ChessPiece {
+public:
+    using ChessPiece::ChessPiece;
+    
+    bool isValidMove(int rowFrom, int colFrom, int rowTo, int colTo) const override;
+    char getSymbol() const override;
+};
+
+/* The Queen class is a subclass of ChessPiece and overrides the isValidMove and getSymbol functions. */
+class Queen : public ChessPiece {
+public:
+    using ChessPiece::ChessPiece;
+    
+    bool isValidMove(int rowFrom, int colFrom, int rowTo, int colTo) const override;
+    char getSymbol() const override;
+};
+
+/* The King class is a subclass of ChessPiece and overrides the isValidMove and getSymbol functions. */
+class King : public ChessPiece {
+public:
+    using ChessPiece::ChessPiece;
+    
+    bool isValidMove(int rowFrom, int colFrom, int rowTo, int colTo) const override;
+    char getSymbol() const override;
+};
+
+/**
+ * The function creates a new piece of the given color from its symbol.
+ *
+ * @param symbol The piece symbol as returned by getSymbol(): 'P', 'R', 'N', 'B', 'Q' or 'K'.
+ * @param color The color of the new piece.
+ *
+ * @return a pointer to the new piece, or nullptr if the symbol is unknown.
+ */
+ChessPiece* createPiece(char symbol, PieceColor color) {
+    switch (pieceTypeOf(symbol)) {
+        case PAWN:   return new Pawn(color);
+        case KNIGHT: return new Knight(color);
+        case BISHOP: return new Bishop(color);
+        case ROOK:   return new Rook(color);
+        case QUEEN:  return new Queen(color);
+        case KING:   return new King(color);
+        default:     return nullptr;
+    }
+}
+
+/**
+ * The ChessBoard constructor initializes the chessboard with pieces, including pawns, rooks, knights,
+ * bishops, queens, and kings.
+ */
+/**
+ * The ChessBoard constructor initializes the chessboard with pieces, including pawns, rooks, knights,
+ * bishops, queens, and kings.
+ */
+// Implementation of member functions for ChessBoard
+ChessBoard::ChessBoard() {
+    // Initialize the chessboard with pieces
+    // Initialize the chessboard with pieces
+    board.resize(8, std::vector<ChessPiece*>(8, nullptr));
+
+    // Initialize pawns
+    for (int i = 0; i < 8; ++i) {
+        board[1][i] = new Pawn(PieceColor::RED);
+        board[6][i] = new Pawn(PieceColor::BLUE);
+    }
+
+    // Initialize rooks
+    board[0][0] = new Rook(PieceColor::RED);
+    board[0][7] = new Rook(PieceColor::RED);
+    board[7][0] = new Rook(PieceColor::BLUE);
+    board[7][7] = new Rook(PieceColor::BLUE);
+    
+    //Initialize Knights
+    board[0][1] = new Knight(PieceColor::RED);
+    board[0][6] = new Knight(PieceColor::RED);
+    board[7][1] = new Knight(PieceColor::BLUE);
+    board[7][6] = new Knight(PieceColor::BLUE);
+
+   //Initialize Bishops
+    board[0][2] = new Bishop(PieceColor::RED);
+    board[0][5] = new Bishop(PieceColor::RED);
+    board[7][2] = new Bishop(PieceColor::BLUE);
+    board[7][5] = new Bishop(PieceColor::BLUE);
+    
+    //Initialize Queens
+    board[0][3] = new Queen(PieceColor::RED);
+    board[7][3] = new Queen(PieceColor::BLUE);
+    
+    //Initialize Kings
+    board[0][4] = new King(PieceColor::RED);
+    board[7][4] = new King(PieceColor::BLUE);
+
+    gameOver = false;
+    rebuildPosition(ALL_CASTLING, -1);
+}
+
+/**
+ * The copy constructor gives the new board its own copy of every piece, so that simulating moves on
+ * the copy (as isMovePuttingKingInCheck does) leaves the original pieces untouched.
+ */
+ChessBoard::ChessBoard(const ChessBoard& other) : gameOver(other.gameOver), quiet(other.quiet) {
+    board.resize(8, std::vector<ChessPiece*>(8, nullptr));
+    for (int i = 0; i < 8; ++i) {
+        for (int j = 0; j < 8; ++j) {
+            ChessPiece* piece = other.board[i][j];
+            if (piece) {
+                board[i][j] = createPiece(piece->getSymbol(), piece->getColor());
+            }
+        }
+    }
+    rebuildPosition(other.position.castlingRights, other.position.epSquare);
+}
+
+/**
+ * The constructor sets up the board with the pieces, castling rights and en-passant square of a
+ * Position, for example one read with parseFen().
+ */
+ChessBoard::ChessBoard(const Position& setup) : gameOver(false) {
+    board.resize(8, std::vector<ChessPiece*>(8, nullptr));
+    for (int square = 0; square < SQUARE_NB; ++square) {
+        if (!setup.isEmpty(square)) {
+            board[rowOf(square)][colOf(square)] = createPiece("PNBRQK"[setup.pieceTypeOn(square)], setup.colorOn(square));
+        }
+    }
+    rebuildPosition(setup.castlingRights, setup.epSquare);
+}
+
+/**
+ * The function links every piece to this board and rebuilds the bitboard mirror of the pieces from
+ * the board array, with the given castling rights and en-passant square.
+ */
+void ChessBoard::rebuildPosition(int castlingRights, int epSquare) {
+    position = Position();
+    position.setCastlingRights(castlingRights);
+    position.setEnPassant(epSquare);
+    for (int i = 0; i < 8; ++i) {
+        for (int j = 0; j < 8; ++j) {
+            ChessPiece* piece = board[i][j];
+            if (piece) {
+                piece->setChessBoard(this);
+                position.put(squareOf(i, j), piece->getColor(), pieceTypeOf(piece->getSymbol()));
+            }
+        }
+    }
+}
+/**
+ * The function `isPathClear` checks if the path between two positions on a chessboard is clear of
+ * obstructions.
+ */
+
+/**
+ * The destructor of the ChessBoard class cleans up dynamically allocated ChessPiece objects.
+ */
+ChessBoard::~ChessBoard() {
+    // Clean up dynamically allocated ChessPiece objects
+    for (auto& row : board) {
+        for (auto& piece : row) {
+            delete piece;
+        }
+    }
+}
+
+/**
+ * The function displays the current state of a chessboard with colored pieces.
+ */
+void ChessBoard::display() const {
+    // Render into one buffer and write it with a single flush
+    std::string text;
+    renderBoard(position, text);
+    std::cout << text << std::flush;
+}
+
+/**
+ * The function returns the ChessPiece object at the specified position on the chess board.
+ * 
+ * @param row The row parameter represents the row index of the chessboard. It specifies the vertical
+ * position of the chess piece on the board. The valid range for the row parameter is from 0 to 7,
+ * inclusive.
+ * @param col The "col" parameter represents the column index of the chessboard. It is used to specify
+ * the column position of the chess piece that we want to retrieve from the chessboard.
+ * 
+ * @return a pointer to a ChessPiece object.
+ */
+ChessPiece* ChessBoard::getPiece(int row, int col) const {
+    // Return the ChessPiece object at the specified position
+    if (row >= 0 && row < 8 && col >= 0 && col < 8) {
+        return board[row][col];
+    } else {
+        return nullptr;
+    }
+}
+
+/**
+ * The function returns the bitboard mirror of the pieces on the board.
+ */
+const Position& ChessBoard::getPosition() const {
+    return position;
+}
+
+/**
+ * The function returns the castling rights still held, as a combination of CastlingRight bits.
+ */
+int ChessBoard::getCastlingRights() const {
+    return position.castlingRights;
+}
+
+/**
+ * The function returns the square a pawn may capture en passant on in the next move, or -1.
+ */
+int ChessBoard::getEnPassantSquare() const {
+    return position.epSquare;
+}
+
+/**
+ * The function generates every move the current player's pieces can make, using the move generator
+ * specialized for that color. Moves that leave the player's own king under threat are included.
+ *
+ * @param currentPlayer The color of the player to generate moves for.
+ *
+ * @return a vector of moves between square indices, where a square index is row * 8 + col.
+ */
+std::vector<Move> ChessBoard::generateMoves(PieceColor currentPlayer) const {
+    MoveList moves;
+    if (currentPlayer == PieceColor::RED) {
+        ::generateMoves<PieceColor::RED>(position, moves);
+    } else {
+        ::generateMoves<PieceColor::BLUE>(position, moves);
+    }
+    return std::vector<Move>(moves.begin(), moves.end());
+}
+
+/**
+ * The function returns every square some piece of the attacker's color can move to, computed for the
+ * whole board in one pass.
+ *
+ * @param attacker The color of the pieces whose attacks are computed.
+ *
+ * @return a bitboard with bit row * 8 + col set for each attacked square.
+ */
+Bitboard ChessBoard::attackedSquares(PieceColor attacker) const {
+    return attacker == PieceColor::RED ? ::attackedSquares<PieceColor::RED>(position)
+                                       : ::attackedSquares<PieceColor::BLUE>(position);
+}
+
+/**
+ * The function checks a batch of candidate moves for the current player in one call. A move is legal
+ * when movePiece would accept it and isMovePuttingKingInCheck would return false for it. The checking
+ * pieces, pins and attacked squares are computed once and shared by all candidates.
+ *
+ * @param candidates The moves to check, with the type of special moves set as moveFor() sets it.
+ * @param currentPlayer The color of the player making the moves.
+ *
+ * @return a bitset with one entry per candidate, true for the legal ones.
+ */
+std::vector<bool> ChessBoard::areMovesLegal(const std::vector<Move>& candidates, PieceColor currentPlayer) const {
+    std::vector<bool> legal;
+    if (currentPlayer == PieceColor::RED) {
+        checkMovesLegal<PieceColor::RED>(position, candidates.data(), candidates.size(), legal);
+    } else {
+        checkMovesLegal<PieceColor::BLUE>(position, candidates.data(), candidates.size(), legal);
+    }
+    return legal;
+}
+
+/**
+ * The function evaluates the capture sequence started by moving the piece on (rowFrom, colFrom) to
+ * (rowTo, colTo), with each side recapturing with its least valuable piece, without changing the
+ * board. It is meant for ranking captures and skipping losing ones during search.
+ *
+ * @return the expected material gain in centipawns for the moving side (negative when the capture
+ * loses material), or 0 if there is no piece on the origin square.
+ */
+int ChessBoard::staticExchange(int rowFrom, int colFrom, int rowTo, int colTo) const {
+    if (!isOnBoard(rowFrom, colFrom) || !isOnBoard(rowTo, colTo) || !board[rowFrom][colFrom]) {
+        return 0;
+    }
+    const Move move = moveFor(position, squareOf(rowFrom, colFrom), squareOf(rowTo, colTo));
+    return board[rowFrom][colFrom]->getColor() == PieceColor::RED ? ::staticExchange<PieceColor::RED>(position, move)
+                                                                   : ::staticExchange<PieceColor::BLUE>(position, move);
+}
+
+/**
+ * The function is the bitboard counterpart of isSquareUnderThreat: it checks if any opponent piece of
+ * currentPlayer attacks the given square. The two agree on squares holding a piece of currentPlayer;
+ * on empty squares isSquareUnderThreat also counts pawns that could step there.
+ */
+bool ChessBoard::isSquareAttacked(int row, int col, PieceColor currentPlayer) const {
+    if (!isOnBoard(row, col)) {
+        return false;
+    }
+    return currentPlayer == PieceColor::RED ? isAttackedBy<PieceColor::BLUE>(position, squareOf(row, col))
+                                            : isAttackedBy<PieceColor::RED>(position, squareOf(row, col));
+}
+
+
+/**
+ * The function `isPathClear` checks if the path between two positions on a chessboard is clear for a
+ * chess piece to move.
+ * 
+ * @param rowFrom The starting row of the chess piece's position.
+ * @param colFrom The parameter `colFrom` represents the starting column of the chess piece's position.
+ * @param rowTo The parameter "rowTo" represents the row number of the destination position on the
+ * chessboard.
+ * @param colTo The parameter `colTo` represents the column index of the destination position on the
+ * chessboard.
+ * 
+ * @return a boolean value. It returns true if the path from the starting position (rowFrom, colFrom)
+ * to the ending position (rowTo, colTo) is clear, and false otherwise.
+ */
+bool ChessPiece::isPathClear(int rowFrom, int colFrom, int rowTo, int colTo) const {
+     int rowDiff = rowTo - rowFrom;
+    int colDiff = colTo - colFrom;
+
+    auto isValidPosition = [](int row, int col) {
+        return row >= 0 && row < 8 && col >= 0 && col < 8;
+    };
+
+    // Check if the path is clear horizontally
+    if (rowDiff == 0) {
+        int colStep = (colDiff > 0) ? 1 : -1;
+        for (int col = colFrom + colStep; col != colTo; col += colStep) {
+            if (!isValidPosition(rowFrom, col) || board->getPiece(rowFrom, col)) {
+                return false; // Obstruction in the path or out of bounds
+            }
+        }
+    }
+    // Check if the path is clear vertically
+    else if (colDiff == 0) {
+        int rowStep = (rowDiff > 0) ? 1 : -1;
+        for (int row = rowFrom + rowStep; row != rowTo; row += rowStep) {
+            if (!isValidPosition(row, colFrom) || board->getPiece(row, colFrom)) {
+                return false; // Obstruction in the path or out of bounds
+            }
+        }
+    }
+    // Check if the path is clear diagonally
+    else if (std::abs(rowDiff) == std::abs(colDiff)) {
+        int rowStep = (rowDiff > 0) ? 1 : -1;
+        int colStep = (colDiff > 0) ? 1 : -1;
+
+        for (int i = 1; i < std::abs(rowDiff); ++i) {
+            int newRow = rowFrom + i * rowStep;
+            int newCol = colFrom + i * colStep;
+            if (!isValidPosition(newRow, newCol) || board->getPiece(newRow, newCol)) {
+                return false; // Obstruction in the path or out of bounds
+            }
+        }
+    } else {
+        // Invalid path
+        return false;
+    }
+
+    // Path is clear
+    return true;
+}
+
+/**
+ * The movePiece function in the ChessBoard class checks if a move is valid and performs the move if it
+ * is, capturing the opponent's king if necessary.
+ * 
+ * @param rowFrom The row index of the square from which the ChessPiece is being moved.
+ * @param colFrom The parameter "colFrom" represents the column index of the square from which the
+ * chess piece is being moved.
+ * @param rowTo The parameter "rowTo" represents the row index of the destination square where the
+ * chess piece is being moved to.
+ * @param colTo The parameter "colTo" represents the column index of the destination square where the
+ * ChessPiece is being moved to.
+ * @param promotion The piece a pawn reaching the last row becomes (a knight, bishop, rook or queen).
+ * A king moving two squares castles, moving the rook as well, and a pawn moving diagonally onto the
+ * en-passant square captures the pawn beside it.
+ * 
+ * @return The `movePiece` function returns a boolean value indicating whether the move was successful
+ * or not. The `isPlayerKingCaptured` function returns a boolean value indicating whether the player's
+ * king is captured or not. The `isGameOver` function returns a boolean value indicating whether the
+ * game is over or not. The `isSquareUnderThreat` function returns a boolean value indicating whether a
+ * given square
+ */
+bool ChessBoard::movePiece(int rowFrom, int colFrom, int rowTo, int colTo, PieceType promotion) {
+    // Move the ChessPiece from (rowFrom, colFrom) to (rowTo, colTo) if (rowFrom >= 0 && rowFrom < 8 && colFrom >= 0 && colFrom < 8 &&
+        if (rowFrom >= 0 && rowFrom < 8 && colFrom >= 0 && colFrom < 8 &&
+        rowTo >= 0 && rowTo < 8 && colTo >= 0 && colTo < 8 &&
+        board[rowFrom][colFrom] && board[rowFrom][colFrom]->isValidMove(rowFrom, colFrom, rowTo, colTo)) {
+        
+        ChessPiece* sourcePiece = board[rowFrom][colFrom];
+        ChessPiece* destinationPiece = board[rowTo][colTo];
+
+        // Check if the destination square is empty or contains a piece of the opposite color
+        if (!destinationPiece || destinationPiece->getColor() != sourcePiece->getColor()) {
+            const PieceColor mover = sourcePiece->getColor();
+            if (promotion < KNIGHT || promotion > QUEEN) {
+                promotion = QUEEN;
+            }
+            const Move move = moveFor(position, squareOf(rowFrom, colFrom), squareOf(rowTo, colTo), promotion);
+
+            // Perform the move if it's a valid move
+            ChessPiece* temp = board[rowTo][colTo];
+            if (move.type() == EN_PASSANT) {
+                // The captured pawn stands beside the moving pawn, not on the destination square
+                temp = board[rowFrom][colTo];
+                board[rowFrom][colTo] = nullptr;
+            } else if (move.type() == CASTLING) {
+                // The rook moves to the square the king passed over
+                int rookFrom = colOf(castlingRookFrom(move.to()));
+                int rookTo = colOf(castlingRookTo(move.to()));
+                board[rowTo][rookTo] = board[rowTo][rookFrom];
+                board[rowTo][rookFrom] = nullptr;
+            }
+            board[rowTo][colTo] = board[rowFrom][colFrom];
+            board[rowFrom][colFrom] = nullptr;
+            if (move.type() == PROMOTION) {
+                delete board[rowTo][colTo];
+                board[rowTo][colTo] = createPiece("PNBRQK"[promotion], mover);
+                board[rowTo][colTo]->setChessBoard(this);
+            }
+            position.makeMove(move);
+
+            // Check if the captured piece is a king
+            bool kingCaptured = dynamic_cast<King*>(temp) != nullptr;
+            delete temp;
+            if (kingCaptured) {
+        // If the king is captured, end the game
+        if (!quiet) {
+            std::cout << "Player "
+                      << (mover == PieceColor::RED ? "BLUE" : "RED")
+                      << " has lost the game. King is captured!" << std::endl;
+        }
+        
+        // Set the game state to over
+        gameOver = true;
+        
+        
+    }
+
+            return true;
+        } else {
+            if (!quiet) {
+                std::cout << "Invalid move. Cannot capture a piece of the same color." << std::endl;
+            }
+            return false;
+        }
+    } else {
+        return false;
+    } 
+}
+
+/**
+ * The function turns off the messages movePiece() prints, for boards that are only used to check
+ * moves. Copies of the board, such as the ones isMovePuttingKingInCheck() makes, stay quiet.
+ */
+void ChessBoard::setQuiet(bool value) {
+    quiet = value;
+}
+
+/**
+ * The function plays move, given as a from and to square with the promotion piece of promotions, like
+ * movePiece(int, int, int, int, PieceType) does.
+ */
+bool ChessBoard::movePiece(Move move) {
+    return movePiece(rowOf(move.from()), colOf(move.from()), rowOf(move.to()), colOf(move.to()),
+                     move.type() == PROMOTION ? move.promotion() : QUEEN);
+}
+
+/**
+ * The function checks if the player's king is captured by iterating through the chess board and
+ * searching for the king piece.
+ * 
+ * @param playerColor The parameter `playerColor` is of type `PieceColor` and represents the color of
+ * the player whose king we want to check if it is captured.
+ * 
+ * @return a boolean value. It returns true if the player's king is captured, and false if the player's
+ * king is still on the board.
+ */
+bool ChessBoard::isPlayerKingCaptured(PieceColor playerColor) const {
+    // Iterate through the board to check if the player's king is captured
+    /* The above code is checking if the player's king is still on the chess board. It iterates through
+    each position on the board and checks if there is a chess piece at that position. If there is a
+    piece and it is a king ('K') of the same color as the player, it returns false, indicating that
+    the king is still on the board. */
+    for (int i = 0; i < 8; ++i) {
+        for (int j = 0; j < 8; ++j) {
+            ChessPiece* piece = board[i][j];
+            if (piece && piece->getSymbol() == 'K' && piece->getColor() == playerColor) {
+                // The player's king is still on the board
+                return false;
+            }
+        }
+    }
+    // The player's king is not found, indicating it is captured
+    return true;
+}
+
+/**
+ * The function checks if the game is over by determining if either player's king has been captured.
+ * 
+ * @return the value of the variable "gameOver", which is a boolean value indicating whether the game
+ * is over or not.
+ */
+bool ChessBoard::isGameOver()  {
+    
+    
+   if (isPlayerKingCaptured(PieceColor::RED) || isPlayerKingCaptured(PieceColor::BLUE)) {
+        gameOver = true;
+    } else {
+       
+       gameOver = false;
+}
+   return gameOver;
+   
+}
+
+
+bool ChessBoard::isSquareUnderThreat(int row, int col, PieceColor currentPlayer) const {
+    // Check if any opponent piece can attack the given square
+     /* The above code is checking if there is any valid move for the current player in a chess game.
+     It iterates through each position on the chess board (8x8) and checks if there is a chess piece
+     at that position. If there is a piece and it belongs to the opponent of the current player, it
+     calls the `isValidMove()` function of that piece to check if it can move to the specified row
+     and column. If a valid move is found, the function returns true. */
+     for (int i = 0; i < 8; ++i) {
+        for (int j = 0; j < 8; ++j) {
+            ChessPiece* piece = board[i][j];
+            if (piece && piece->getColor() != currentPlayer && piece->isValidMove(i, j, row, col)) {
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+bool ChessBoard::canEscapeCheck(int kingRow, int kingCol, PieceColor currentPlayer) const {
+    // Check if the king can move to any square that is not under threat
+   /* The above code is checking if there is at least one square on a chessboard that is not under
+   threat from the opponent's pieces. A single attackedSquares() call computes the threat on all
+   64 squares at once; if any square is left out, the king can escape check. */
+    return ~attackedSquares(opponentOf(currentPlayer)) != 0;
+}
+
+/**
+ * The code checks if a move puts the king in check and if the current player is in checkmate.
+ * 
+ * @param fromRow The row index of the piece's current position on the chessboard.
+ * @param fromCol The column index of the starting position of the piece being moved.
+ * @param toRow The parameter "toRow" represents the row number of the destination square where the
+ * piece is being moved to.
+ * @param toCol The parameter "toCol" represents the column index of the destination square where the
+ * piece is being moved to.
+ * @param currentPlayer The parameter "currentPlayer" represents the color of the current player. It is
+ * of type "PieceColor", which is an enumeration that can have two possible values: "White" or "Black".
+ * This parameter is used to determine which player's king to check for checkmate.
+ * 
+ * @return The first function, `isMovePuttingKingInCheck`, returns a boolean value indicating whether a
+ * move puts the king in check.
+ */
+bool ChessBoard::isMovePuttingKingInCheck(int fromRow, int fromCol, int toRow, int toCol, PieceColor currentPlayer) const {
+    // Make a copy of the board and simulate the move
+    ChessBoard tempBoard(*this);
+    tempBoard.movePiece(fromRow, fromCol, toRow, toCol);
+
+    // Get the king's position
+    int kingRow = -1;
+    int kingCol = -1;
+
+    // Find the king's position
+    /* The above code is searching for the position of the current player's king on a chessboard
+    represented by the `tempBoard` object. It iterates through each cell on the board using nested
+    for loops, and checks if there is a non-null chess piece at that position. If there is a piece
+    and it is a king of the current player's color, the `kingRow` and `kingCol` variables are
+    updated with the row and column indices of the king's position. The code then breaks out of the
+    inner loop and continues with the rest of the program. */
+    for (int i = 0; i < 8; ++i) {
+        for (int j = 0; j < 8; ++j) {
+            ChessPiece* piece = tempBoard.getPiece(i, j);
+            if (piece && piece->getColor() == currentPlayer && dynamic_cast<King*>(piece)) {
+                kingRow = i;
+                kingCol = j;
+                break;
+            }
+        }
+    }
+
+    /* The above code is checking if the variables `kingRow` and `kingCol` are equal to -1. If either
+    of them is -1, it means that the king was not found, and the code returns false. */
+    if (kingRow == -1 || kingCol == -1) {
+        // King not found
+        return false;
+    }
+
+    // Check if the king is in check on the temporary board
+    return tempBoard.isSquareUnderThreat(kingRow, kingCol, currentPlayer);
+}
+
+
+/**
+ * The function `isCheckmate` checks if the current player's king is in checkmate by iterating through
+ * the board, finding the king's position, checking if the king is in check, and then checking if there
+ * are any legal moves to get the king out of check.
+ * 
+ * @param currentPlayer The parameter "currentPlayer" represents the color of the player whose turn it
+ * is to move. It can be either "PieceColor::WHITE" or "PieceColor::BLACK", indicating whether it is
+ * the white player or the black player's turn.
+ * 
+ * @return a boolean value. It returns true if the current player's king is in checkmate, and false
+ * otherwise.
+ */
+bool ChessBoard::isCheckmate(PieceColor currentPlayer) {
+    // Iterate through the board to find the current player's king
+  int kingRow = -1;
+    int kingCol = -1;
+
+    // Find the king's position
+   /* The above code is searching for the position of the current player's king on a chessboard. It
+   iterates through each cell on the chessboard and checks if there is a piece at that position. If
+   there is a piece and it is the current player's king, the code stores the row and column of the
+   king's position in the variables kingRow and kingCol. */
+    for (int i = 0; i < 8; ++i) {
+        for (int j = 0; j < 8; ++j) {
+            ChessPiece* piece = getPiece(i, j);
+            if (piece && piece->getColor() == currentPlayer && dynamic_cast<King*>(piece)) {
+                kingRow = i;
+                kingCol = j;
+                break;
+            }
+        }
+    }
+
+    /* The above code is checking if the variables `kingRow` and `kingCol` are equal to -1. If either
+    of them is -1, it means that the king was not found, and the code returns false. */
+    if (kingRow == -1 || kingCol == -1) {
+        // King not found
+        return false;
+    }
+
+    // Check if the king is in check
+    /* The above code is checking if the king is under threat (in check) by calling the function
+    `isSquareUnderThreat` with the parameters `kingRow`, `kingCol`, and `currentPlayer`. If the king
+    is not under threat, the code returns `false`, indicating that the king is not in checkmate. */
+    if (!isSquareUnderThreat(kingRow, kingCol, currentPlayer)) {
+        return false; // King is not in check, so not in checkmate
+    }
+
+    // Check if there are any legal moves to get the king out of check
+    /* The above code is a nested loop that iterates through each square on a chessboard (8x8). It
+    checks if there is a chess piece on the current square and if the piece belongs to the current
+    player. If both conditions are met, it then checks all possible moves for that piece. */
+    for (int i = 0; i < 8; ++i) {
+        for (int j = 0; j < 8; ++j) {
+            ChessPiece* piece = getPiece(i, j);
+            if (piece && piece->getColor() == currentPlayer) {
+                for (int toRow = 0; toRow < 8; ++toRow) {
+                    for (int toCol = 0; toCol < 8; ++toCol) {
+                        ChessPiece* target = getPiece(toRow, toCol);
+                        // The move is simulated on a copy of the board, so this board is left unchanged
+                        if (piece->isValidMove(i, j, toRow, toCol) &&
+                            (!target || target->getColor() != currentPlayer) &&
+                            !isMovePuttingKingInCheck(i, j, toRow, toCol, currentPlayer)) {
+                            // The move is legal and gets the king out of check
+                            return false;
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    // No legal moves to get the king out of check, so it's checkmate
+    return true;
+}
+
+/**
+ * The above code implements the isValidMove and getSymbol functions for different chess pieces.
+ * 
+ * @param rowFrom The row index of the current position of the piece.
+ * @param colFrom The parameter "colFrom" represents the column index of the starting position of the
+ * piece.
+ * @param rowTo The parameter "rowTo" represents the row index of the destination position where the
+ * piece is being moved to.
+ * @param colTo The parameter "colTo" represents the column index of the destination position where the
+ * piece is being moved to.
+ * 
+ * @return In each of the member functions, a boolean value is being returned. This value represents
+ * whether the move from the starting position (rowFrom, colFrom) to the destination position (rowTo,
+ * colTo) is a valid move for the specific chess piece.
+ */
+// Implementation of member functions for Pawn
+bool Pawn::isValidMove(int rowFrom, int colFrom, int rowTo, int colTo) const {
+
+//Pawn movement logic
+    /* A red pawn moves upward and a blue pawn downward: one step forward onto an empty square, two
+    steps forward from the starting position when both squares are empty, or one step diagonally to
+    capture an opponent piece. A diagonal step onto the en-passant square captures the opponent pawn
+    that has just passed it. */
+    if (!isOnBoard(rowFrom, colFrom) || !isOnBoard(rowTo, colTo)) {
+        return false;
+    }
+    int forward = (getColor() == PieceColor::RED) ? 1 : -1;
+    int startRow = (getColor() == PieceColor::RED) ? 1 : 6;
+    int rowDiff = rowTo - rowFrom;
+    int colDiff = colTo - colFrom;
+    ChessPiece* target = board->getPiece(rowTo, colTo);
+
+    if (colDiff == 0) {
+        if (rowDiff == forward) {
+            return !target;
+        }
+        return rowDiff == 2 * forward && rowFrom == startRow && !target && !board->getPiece(rowFrom + forward, colFrom);
+    }
+    if (std::abs(colDiff) != 1 || rowDiff != forward) {
+        return false;
+    }
+    if (target) {
+        return target->getColor() != getColor();
+    }
+    ChessPiece* passed = board->getPiece(rowFrom, colTo);
+    return squareOf(rowTo, colTo) == board->getEnPassantSquare() && rowTo == startRow + 4 * forward && passed &&
+           passed->getColor() != getColor() && passed->getSymbol() == 'P';
+}
+
+/**
+ * The function returns the symbol 'P' for a Pawn object.
+ * 
+ * @return The character 'P' is being returned.
+ */
+char Pawn::getSymbol() const {
+    return 'P';
+}
+
+/**
+ * The isValidMove function checks if a move for a Rook piece is valid by ensuring that the move is
+ * either horizontal or vertical and that the path between the starting and ending positions is clear.
+ * 
+ * @param rowFrom The starting row of the Rook's position on the chessboard.
+ * @param colFrom The column index of the starting position of the Rook.
+ * @param rowTo The row index of the destination position where the Rook is being moved to.
+ * @param colTo The parameter "colTo" represents the column index of the destination position where the
+ * Rook is being moved to.
+ * 
+ * @return a boolean value.
+ */
+// Implementation of member functions for Rook
+bool Rook::isValidMove(int rowFrom, int colFrom, int rowTo, int colTo) const {
+    // Rook movement logic
+      int rowDiff = rowTo - rowFrom;
+      int colDiff = colTo - colFrom;
+
+    // Rook can move horizontally or vertically
+    return (rowDiff == 0 || colDiff == 0) && isPathClear(rowFrom, colFrom, rowTo, colTo);
+
+}
+
+/**
+ * The function returns the symbol 'R' for a Rook piece.
+ * 
+ * @return The character 'R' is being returned.
+ */
+char Rook::getSymbol() const {
+    return 'R';
+}
+
+/**
+ * The isValidMove function checks if the move from (rowFrom, colFrom) to (rowTo, colTo) is a valid
+ * move for a Knight in chess.
+ * 
+ * @param rowFrom The row index of the starting position of the Knight's move.
+ * @param colFrom The column index of the starting position of the Knight.
+ * @param rowTo The row index of the destination position where the Knight is being moved to.
+ * @param colTo The parameter "colTo" represents the column index of the destination position where the
+ * Knight is being moved to.
+ * 
+ * @return a boolean value.
+ */
+// Implementation of member functions for Knight
+bool Knight::isValidMove(int rowFrom, int colFrom, int rowTo, int colTo) const {
+   // Knight movement logic
+    if (!isOnBoard(rowFrom, colFrom) || !isOnBoard(rowTo, colTo)) {
+        return false;
+    }
+    int rowDiff = std::abs(rowTo - rowFrom);
+    int colDiff = std::abs(colTo - colFrom);
+    return (rowDiff == 2 && colDiff == 1) || (rowDiff == 1 && colDiff == 2);
+}
+
+/**
+ * The function returns the symbol 'N' for a Knight.
+ * 
+ * @return The character 'N' is being returned.
+ */
+char Knight::getSymbol() const {
+    return 'N';
+}
+
+/**
+ * The isValidMove function checks if the move for a Bishop or Queen is valid based on the movement
+ * logic and if the path is clear.
+ * 
+ * @param rowFrom The row index of the starting position of the piece.
+ * @param colFrom The column index of the starting position of the piece.
+ * @param rowTo The row index of the destination position where the piece is being moved to.
+ * @param colTo The parameter "colTo" represents the column index of the destination position on the
+ * chessboard.
+ * 
+ * @return In the `isValidMove` function for both the Bishop and Queen classes, a boolean value is
+ * being returned. This boolean value represents whether the move from the starting position (rowFrom,
+ * colFrom) to the ending position (rowTo, colTo) is a valid move for the respective chess piece.
+ */
+// Implementation of member functions for Bishop
+bool Bishop::isValidMove(int rowFrom, int colFrom, int rowTo, int colTo) const {
+    // Bishop movement logic
+    int rowDiff = rowTo - rowFrom;
+    int colDiff = colTo - colFrom;
+
+    return std::abs(rowDiff) == std::abs(colDiff) && isPathClear(rowFrom, colFrom, rowTo, colTo);
+    
+    
+}
+
+/**
+ * The function returns the symbol 'B' for a Bishop piece.
+ * 
+ * @return The character 'B' is being returned.
+ */
+char Bishop::getSymbol() const {
+    return 'B';
+}
+
+// Implementation of member functions for Queen
+bool Queen::isValidMove(int rowFrom, int colFrom, int rowTo, int colTo) const {
+     //Queen movement logic (combination of rook and bishop)
+    int rowDiff = rowTo - rowFrom;
+    int colDiff = colTo - colFrom;
+
+    return (rowDiff == 0 || colDiff == 0 || std::abs(rowDiff) == std::abs(colDiff)) &&
+           isPathClear(rowFrom, colFrom, rowTo, colTo);
+    
+   
+}
+
+/**
+ * The function returns the symbol 'Q' for a Queen chess piece.
+ * 
+ * @return The character 'Q' is being returned.
+ */
+char Queen::getSymbol() const {
+    return 'Q';
+}
+
+// Implementation of member functions for King
+/**
+ * The function checks if a move for a King piece in a chess game is valid: a step of one square in
+ * any direction, or castling two squares towards a rook along the first row. Castling needs the
+ * right for that side, the rook on its starting square, empty squares between king and rook and a
+ * king that is not in check and does not pass a threatened square; the destination is checked like
+ * any other move by isMovePuttingKingInCheck.
+ * 
+ * @param rowFrom The row index of the current position of the King piece on the chessboard.
+ * @param colFrom The column index of the current position of the King.
+ * @param rowTo The row index of the destination position where the King wants to move.
+ * @param colTo The parameter "colTo" represents the column index of the destination position where the
+ * King is being moved to.
+ * 
+ * @return a boolean value.
+ */
+bool King::isValidMove(int rowFrom, int colFrom, int rowTo, int colTo) const {
+    // King movement logic
+    int rowDiff = std::abs(rowTo - rowFrom);
+     int colDiff = std::abs(colTo - colFrom);
+
+    if (rowDiff <= 1 && colDiff <= 1) {
+        return rowDiff + colDiff > 0;
+    }
+
+    // Castling
+    int homeRow = (getColor() == PieceColor::RED) ? 0 : 7;
+    if (rowFrom != homeRow || colFrom != 4 || rowTo != homeRow || colDiff != 2) {
+        return false;
+    }
+    bool kingSide = colTo > colFrom;
+    int rookCol = kingSide ? 7 : 0;
+    ChessPiece* rook = board->getPiece(homeRow, rookCol);
+    if (!(board->getCastlingRights() & castlingRight(getColor(), kingSide)) || !rook || rook->getSymbol() != 'R' ||
+        rook->getColor() != getColor() || !isPathClear(rowFrom, colFrom, homeRow, rookCol)) {
+        return false;
+    }
+    int passedCol = kingSide ? colFrom + 1 : colFrom - 1;
+    return !board->isSquareUnderThreat(rowFrom, colFrom, getColor()) &&
+           !board->isMovePuttingKingInCheck(rowFrom, colFrom, homeRow, passedCol, getColor());
+}
+
+/**
+ * The function returns the symbol 'K' for the King piece.
+ * 
+ * @return The character 'K' is being returned.
+ */
+char King::getSymbol() const {
+    return 'K';
+}
+
+
+
+/* The code below implements a compact binary archive of games. Each move is packed into 16 bits,
+each game has a small header, and an index of game offsets at the end of the file lets a reader
+seek straight to any game. The reader memory-maps the file, so games are replayed directly from
+the mapped bytes without copying or parsing. All fields are stored little-endian. */
+
+/**
+ * The MappedFile class maps a whole file read-only into memory. On platforms without mmap the file is
+ * read into a buffer instead.
+ */
+class MappedFile {
+public:
+    MappedFile() = default;
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+    ~MappedFile() {
+        close();
+    }
+
+    bool open(const std::string& path);
+    void close();
+
+    const char* data() const {
+        return bytes;
+    }
+
+    std::size_t size() const {
+        return length;
+    }
+
+private:
+    const char* bytes = nullptr;
+    std::size_t length = 0;
+#if defined(_WIN32)
+    std::vector<char> buffer;
+#endif
+};
+
+/**
+ * The function maps the file at path into memory, replacing any file mapped before.
+ *
+ * @return true if the file was opened and mapped, false otherwise.
+ */
+bool MappedFile::open(const std::string& path) {
+    close();
+#if defined(_WIN32)
+    std::ifstream in(path, std::ios::binary);
+    if (!in) {
+        return false;
+    }
+    buffer.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+    bytes = buffer.data();
+    length = buffer.size();
+    return true;
+#else
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        return false;
+    }
+    struct stat info;
+    if (::fstat(fd, &info) != 0) {
+        ::close(fd);
+        return false;
+    }
+    length = static_cast<std::size_t>(info.st_size);
+    if (length > 0) {
+        void* mapping = ::mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (mapping == MAP_FAILED) {
+            ::close(fd);
+            length = 0;
+            return false;
+        }
+        bytes = static_cast<const char*>(mapping);
+    }
+    ::close(fd);
+    return true;
+#endif
+}
+
+/**
+ * The function unmaps the file, if one is mapped.
+ */
+void MappedFile::close() {
+#if defined(_WIN32)
+    buffer.clear();
+#else
+    if (bytes) {
+        ::munmap(const_cast<char*>(bytes), length);
+    }
+#endif
+    bytes = nullptr;
+    length = 0;
+}
+
+// enum to represent the outcome of an archived game
+enum class GameResult : std::uint8_t {
+    UNKNOWN,
+    RED_WINS,
+    BLUE_WINS,
+    DRAW
+};
+
+/* A packed move holds the from square in bits 0-5, the to square in bits 6-11 and the promotion
+piece in bits 12-15 (the PieceType plus one, or 0 when the move is not a promotion). */
+constexpr std::uint16_t encodeMove(int from, int to, int promotion = 0) {
+    return static_cast<std::uint16_t>(from | (to << 6) | (promotion << 12));
+}
+
+constexpr int encodedFrom(std::uint16_t code) {
+    return code & 0x3F;
+}
+
+constexpr int encodedTo(std::uint16_t code) {
+    return (code >> 6) & 0x3F;
+}
+
+constexpr int encodedPromotion(std::uint16_t code) {
+    return code >> 12;
+}
+
+// The archive code of move; castling and en passant are implied by the position it is played in
+constexpr std::uint16_t encodeMove(Move move) {
+    return encodeMove(move.from(), move.to(), move.type() == PROMOTION ? move.promotion() + 1 : 0);
+}
+
+// The move an archive code stands for when played in position
+inline Move decodeMove(const Position& position, std::uint16_t code) {
+    const int promotion = encodedPromotion(code);
+    return moveFor(position, encodedFrom(code), encodedTo(code),
+                   promotion ? static_cast<PieceType>(promotion - 1) : QUEEN);
+}
+
+// File header at offset 0 of an archive
+struct ArchiveHeader {
+    char magic[4];
+    std::uint32_t version;
+    std::uint64_t gameCount;
+    std::uint64_t indexOffset;
+};
+
+// Header in front of the moves of each game; every game record is padded to a multiple of 8 bytes
+struct ArchiveGameHeader {
+    std::uint32_t moveCount;
+    GameResult result;
+    std::uint8_t reserved[3];
+};
+
+static_assert(sizeof(ArchiveHeader) == 24, "archive header layout");
+static_assert(sizeof(ArchiveGameHeader) == 8, "archive game header layout");
+
+constexpr char ArchiveMagic[4] = {'C', 'G', 'A', '1'};
+// Version 2: moves follow the full rules, with castling, en passant and promotions
+constexpr std::uint32_t ArchiveVersion = 2;
+
+/**
+ * The GameArchiveWriter class writes games one by one into a new archive file.
+ */
+class GameArchiveWriter {
+public:
+    bool open(const std::string& path);
+    void addGame(const std::uint16_t* moves, std::uint32_t moveCount, GameResult result);
+    bool close();
+
+private:
+    std::ofstream out;
+    std::vector<std::uint64_t> offsets;
+    std::uint64_t offset = 0;
+
+    void write(const void* data, std::size_t size);
+};
+
+void GameArchiveWriter::write(const void* data, std::size_t size) {
+    out.write(static_cast<const char*>(data), static_cast<std::streamsize>(size));
+    offset += size;
+}
+
+/**
+ * The function creates the archive file and writes a placeholder header, which close() completes.
+ *
+ * @return true if the file could be created.
+ */
+bool GameArchiveWriter::open(const std::string& path) {
+    out.open(path, std::ios::binary | std::ios::trunc);
+    if (!out) {
+        return false;
+    }
+    offsets.clear();
+    offset = 0;
+    ArchiveHeader header{};
+    write(&header, sizeof(header));
+    return true;
+}
+
+/**
+ * The function appends one game to the archive.
+ *
+ * @param moves The packed moves of the game, see encodeMove().
+ * @param moveCount The number of moves.
+ * @param result The outcome of the game.
+ */
+void GameArchiveWriter::addGame(const std::uint16_t* moves, std::uint32_t moveCount, GameResult result) {
+    static const char padding[8] = {};
+    offsets.push_back(offset);
+    ArchiveGameHeader header{};
+    header.moveCount = moveCount;
+    header.result = result;
+    write(&header, sizeof(header));
+    write(moves, moveCount * sizeof(std::uint16_t));
+    write(padding, (8 - offset % 8) % 8);
+}
+
+/**
+ * The function writes the game index, fills in the file header and closes the file.
+ *
+ * @return true if everything was written successfully.
+ */
+bool GameArchiveWriter::close() {
+    ArchiveHeader header{};
+    std::memcpy(header.magic, ArchiveMagic, sizeof(header.magic));
+    header.version = ArchiveVersion;
+    header.gameCount = offsets.size();
+    header.indexOffset = offset;
+    write(offsets.data(), offsets.size() * sizeof(std::uint64_t));
+    out.seekp(0);
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    out.close();
+    return !out.fail();
+}
+
+// A game inside a mapped archive; moves points into the mapping
+struct ArchivedGame {
+    const std::uint16_t* moves;
+    std::uint32_t moveCount;
+    GameResult result;
+};
+
+/**
+ * The GameArchive class gives random access to the games of a memory-mapped archive.
+ */
+class GameArchive {
+public:
+    bool open(const std::string& path);
+
+    std::uint64_t gameCount() const {
+        return count;
+    }
+
+    ArchivedGame game(std::uint64_t number) const;
+    bool replay(std::uint64_t number, ChessBoard& chessBoard, std::uint32_t plies = UINT32_MAX) const;
+
+private:
+    MappedFile file;
+    const std::uint64_t* index = nullptr;
+    std::uint64_t count = 0;
+};
+
+/**
+ * The function maps an archive file and checks its header and index. Every game record must lie
+ * between the file header and the index, so game() never reads outside the mapping.
+ *
+ * @return true if the file is a readable archive.
+ */
+bool GameArchive::open(const std::string& path) {
+    count = 0;
+    index = nullptr;
+    if (!file.open(path) || file.size() < sizeof(ArchiveHeader)) {
+        return false;
+    }
+    const ArchiveHeader* header = reinterpret_cast<const ArchiveHeader*>(file.data());
+    if (std::memcmp(header->magic, ArchiveMagic, sizeof(ArchiveMagic)) != 0 || header->version != ArchiveVersion ||
+        header->indexOffset % 8 != 0 || header->indexOffset < sizeof(ArchiveHeader) ||
+        header->indexOffset > file.size() ||
+        header->gameCount > (file.size() - header->indexOffset) / sizeof(std::uint64_t)) {
+        return false;
+    }
+    const std::uint64_t* offsets = reinterpret_cast<const std::uint64_t*>(file.data() + header->indexOffset);
+    for (std::uint64_t i = 0; i < header->gameCount; ++i) {
+        const std::uint64_t offset = offsets[i];
+        if (offset % 8 != 0 || offset < sizeof(ArchiveHeader) ||
+            offset > header->indexOffset - sizeof(ArchiveGameHeader)) {
+            return false;
+        }
+        const ArchiveGameHeader* game = reinterpret_cast<const ArchiveGameHeader*>(file.data() + offset);
+        if (game->moveCount > (header->indexOffset - offset - sizeof(ArchiveGameHeader)) / sizeof(std::uint16_t)) {
+            return false;
+        }
+    }
+    index = offsets;
+    count = header->gameCount;
+    return true;
+}
+
+/**
+ * The function returns game number (counting from 0) without copying its moves.
+ */
+ArchivedGame GameArchive::game(std::uint64_t number) const {
+    const char* record = file.data() + index[number];
+    const ArchiveGameHeader* header = reinterpret_cast<const ArchiveGameHeader*>(record);
+    return {reinterpret_cast<const std::uint16_t*>(record + sizeof(ArchiveGameHeader)), header->moveCount,
+            header->result};
+}
+
+/**
+ * The function replays the first plies moves of game number on chessBoard, which should hold the
+ * starting position.
+ *
+ * @return true if every move was accepted by ChessBoard::movePiece.
+ */
+bool GameArchive::replay(std::uint64_t number, ChessBoard& chessBoard, std::uint32_t plies) const {
+    ArchivedGame archived = game(number);
+    std::uint32_t end = std::min(plies, archived.moveCount);
+    for (std::uint32_t i = 0; i < end; ++i) {
+        if (!chessBoard.movePiece(decodeMove(chessBoard.getPosition(), archived.moves[i]))) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * The function parses a square in the coordinate notation used by main(), such as "A2" or "e4".
+ *
+ * @return the square index, or -1 if the text is not a square.
+ */
+int parseSquare(const std::string& text, std::size_t pos) {
+    if (pos + 2 > text.size()) {
+        return -1;
+    }
+    int col = std::toupper(static_cast<unsigned char>(text[pos])) - 'A';
+    int row = text[pos + 1] - '1';
+    return isOnBoard(row, col) ? squareOf(row, col) : -1;
+}
+
+/**
+ * The function parses a move in coordinate notation, the origin square followed by the destination
+ * and, for a promotion, the letter of the new piece (e.g. "e2e4" or "e7e8q"; queen if omitted).
+ *
+ * @return false if the text is not a move.
+ */
+bool parseMoveText(const std::string& text, int& from, int& to, PieceType& promotion) {
+    from = parseSquare(text, 0);
+    to = parseSquare(text, 2);
+    promotion = QUEEN;
+    if (text.size() == 5) {
+        promotion = pieceTypeOf(static_cast<char>(std::toupper(static_cast<unsigned char>(text[4]))));
+    }
+    return (text.size() == 4 || text.size() == 5) && from >= 0 && to >= 0 && promotion >= KNIGHT &&
+           promotion <= QUEEN;
+}
+
+/**
+ * The function converts a text move log into an archive. Each line holds one game as moves in the
+ * coordinate notation of parseMoveText() (e.g. "a2a4 b7b5"), optionally ending with a result of "1-0" (RED wins), "0-1" (BLUE wins) or "1/2-1/2".
+ * Lines that are empty or start with '#' are skipped. Each game is replayed on a ChessBoard, and a
+ * game with an illegal move is reported and left out.
+ *
+ * @return true if the archive was written.
+ */
+bool convertMoveLog(const std::string& logPath, const std::string& archivePath) {
+    std::ifstream in(logPath);
+    if (!in) {
+        std::cerr << "Cannot open " << logPath << std::endl;
+        return false;
+    }
+    GameArchiveWriter writer;
+    if (!writer.open(archivePath)) {
+        std::cerr << "Cannot create " << archivePath << std::endl;
+        return false;
+    }
+
+    std::string line;
+    std::string token;
+    std::vector<std::uint16_t> moves;
+    std::size_t lineNumber = 0;
+    std::size_t skipped = 0;
+    while (std::getline(in, line)) {
+        ++lineNumber;
+        if (line.empty() || line[0] == '#') {
+            continue;
+        }
+        ChessBoard chessBoard;
+        PieceColor currentPlayer = PieceColor::RED;
+        GameResult result = GameResult::UNKNOWN;
+        bool valid = true;
+        moves.clear();
+
+        std::istringstream tokens(line);
+        while (valid && tokens >> token) {
+            if (token == "1-0" || token == "0-1" || token == "1/2-1/2") {
+                result = token == "1-0" ? GameResult::RED_WINS
+                       : token == "0-1" ? GameResult::BLUE_WINS : GameResult::DRAW;
+                continue;
+            }
+            int from;
+            int to;
+            PieceType promotion;
+            valid = parseMoveText(token, from, to, promotion);
+            ChessPiece* piece = valid ? chessBoard.getPiece(rowOf(from), colOf(from)) : nullptr;
+            Move move = valid ? moveFor(chessBoard.getPosition(), from, to, promotion) : Move();
+            valid = piece && piece->getColor() == currentPlayer && chessBoard.movePiece(move);
+            if (valid) {
+                moves.push_back(encodeMove(move));
+                currentPlayer = opponentOf(currentPlayer);
+            }
+        }
+        if (!valid) {
+            std::cerr << "Line " << lineNumber << ": invalid move '" << token << "', game skipped" << std::endl;
+            ++skipped;
+            continue;
+        }
+        writer.addGame(moves.data(), static_cast<std::uint32_t>(moves.size()), result);
+    }
+    if (!writer.close()) {
+        std::cerr << "Cannot write " << archivePath << std::endl;
+        return false;
+    }
+    std::cout << "Converted " << lineNumber << " lines, " << skipped << " games skipped" << std::endl;
+    return true;
+}
+
+/**
+ * The function writes an archive of random games, each ending when a player has no move that keeps
+ * its king safe, a king is captured or maxPlies moves were played.
+ *
+ * @return true if the archive was written.
+ */
+bool writeRandomArchive(const std::string& archivePath, std::uint64_t games, std::uint32_t seed, int maxPlies = 200) {
+    GameArchiveWriter writer;
+    if (!writer.open(archivePath)) {
+        std::cerr << "Cannot create " << archivePath << std::endl;
+        return false;
+    }
+    std::mt19937 random(seed);
+    std::vector<std::uint16_t> moves;
+    std::vector<Move> legalMoves;
+    for (std::uint64_t g = 0; g < games; ++g) {
+        ChessBoard chessBoard;
+        PieceColor currentPlayer = PieceColor::RED;
+        moves.clear();
+        for (int ply = 0; ply < maxPlies && !chessBoard.isGameOver(); ++ply) {
+            std::vector<Move> candidates = chessBoard.generateMoves(currentPlayer);
+            std::vector<bool> legal = chessBoard.areMovesLegal(candidates, currentPlayer);
+            legalMoves.clear();
+            for (std::size_t i = 0; i < candidates.size(); ++i) {
+                if (legal[i]) {
+                    legalMoves.push_back(candidates[i]);
+                }
+            }
+            if (legalMoves.empty()) {
+                break;
+            }
+            Move move = legalMoves[random() % legalMoves.size()];
+            chessBoard.movePiece(move);
+            moves.push_back(encodeMove(move));
+            currentPlayer = opponentOf(currentPlayer);
+        }
+        writer.addGame(moves.data(), static_cast<std::uint32_t>(moves.size()), GameResult::UNKNOWN);
+    }
+    return writer.close();
+}
+
+/**
+ * The function benchmarks reading an archive: mapping it, scanning every packed move, and replaying
+ * every game through ChessBoard.
+ *
+ * @return true if the archive could be read.
+ */
+bool benchmarkArchive(const std::string& archivePath) {
+    using Clock = std::chrono::steady_clock;
+    auto seconds = [](Clock::time_point start) {
+        return std::chrono::duration<double>(Clock::now() - start).count();
+    };
+
+    Clock::time_point start = Clock::now();
+    GameArchive archive;
+    if (!archive.open(archivePath)) {
+        std::cerr << "Cannot read archive " << archivePath << std::endl;
+        return false;
+    }
+    double openTime = seconds(start);
+
+    // Touch every move so the scan measures raw read throughput
+    start = Clock::now();
+    std::uint64_t totalMoves = 0;
+    std::uint64_t checksum = 0;
+    for (std::uint64_t g = 0; g < archive.gameCount(); ++g) {
+        ArchivedGame game = archive.game(g);
+        for (std::uint32_t i = 0; i < game.moveCount; ++i) {
+            checksum += game.moves[i];
+        }
+        totalMoves += game.moveCount;
+    }
+    double scanTime = seconds(start);
+
+    start = Clock::now();
+    std::uint64_t failed = 0;
+    for (std::uint64_t g = 0; g < archive.gameCount(); ++g) {
+        ChessBoard chessBoard;
+        failed += !archive.replay(g, chessBoard);
+    }
+    double replayTime = seconds(start);
+
+    double megabytes = totalMoves * sizeof(std::uint16_t) / 1e6;
+    std::cout << std::fixed << std::setprecision(3)
+              << "Games: " << archive.gameCount() << ", moves: " << totalMoves << " (checksum " << checksum << ")\n"
+              << "Open:   " << openTime * 1e3 << " ms\n"
+              << "Scan:   " << scanTime * 1e3 << " ms, " << totalMoves / std::max(scanTime, 1e-9) / 1e6
+              << " M moves/s, " << megabytes / std::max(scanTime, 1e-9) << " MB/s\n"
+              << "Replay: " << replayTime * 1e3 << " ms, " << archive.gameCount() / std::max(replayTime, 1e-9)
+              << " games/s, " << totalMoves / std::max(replayTime, 1e-9) / 1e6 << " M plies/s, "
+              << failed << " games failed" << std::endl;
+    return failed == 0;
+}
+
+/* The code below implements an on-disk index from position hashes to the (game, ply) pairs of an
+archive where the position occurred, with ply 0 being the starting position. The index is a header
+followed by entries sorted by key, so a lookup is a binary search over the mapped file. */
+
+// One posting of the position index
+struct PositionIndexEntry {
+    Key key;
+    std::uint32_t game;
+    std::uint32_t ply;
+};
+
+// File header at offset 0 of a position index
+struct PositionIndexHeader {
+    char magic[4];
+    std::uint32_t version;
+    std::uint64_t entryCount;
+};
+
+static_assert(sizeof(PositionIndexEntry) == 16, "position index entry layout");
+static_assert(sizeof(PositionIndexHeader) == 16, "position index header layout");
+
+constexpr char PositionIndexMagic[4] = {'C', 'P', 'I', '1'};
+// Version 2: keys include the castling rights and the en-passant square
+constexpr std::uint32_t PositionIndexVersion = 2;
+
+inline bool operator<(const PositionIndexEntry& a, const PositionIndexEntry& b) {
+    if (a.key != b.key) {
+        return a.key < b.key;
+    }
+    return a.game != b.game ? a.game < b.game : a.ply < b.ply;
+}
+
+/**
+ * The function builds a position index for an archive. The games are split between threads, each of
+ * which replays its share and sorts its postings; the sorted runs are then merged into the file.
+ *
+ * @param threadCount The number of worker threads, or 0 to use every core.
+ *
+ * @return true if the index was written.
+ */
+bool buildPositionIndex(const std::string& archivePath, const std::string& indexPath, unsigned threadCount = 0) {
+    GameArchive archive;
+    if (!archive.open(archivePath)) {
+        std::cerr << "Cannot read archive " << archivePath << std::endl;
+        return false;
+    }
+    if (threadCount == 0) {
+        threadCount = std::max(1u, std::thread::hardware_concurrency());
+    }
+
+    const Position start = ChessBoard().getPosition();
+    const std::uint64_t games = archive.gameCount();
+    std::vector<std::vector<PositionIndexEntry>> runs(threadCount);
+    std::atomic<std::uint64_t> failed(0);
+    std::vector<std::thread> workers;
+    for (unsigned t = 0; t < threadCount; ++t) {
+        workers.emplace_back([&, t]() {
+            std::vector<PositionIndexEntry>& run = runs[t];
+            for (std::uint64_t g = games * t / threadCount; g < games * (t + 1) / threadCount; ++g) {
+                ArchivedGame game = archive.game(g);
+                Position position = start;
+                PieceColor sideToMove = PieceColor::RED;
+                run.push_back({positionKey(position, sideToMove), static_cast<std::uint32_t>(g), 0});
+                for (std::uint32_t ply = 0; ply < game.moveCount; ++ply) {
+                    // A corrupt move ends the game; the positions before it stay indexed
+                    const Move move = decodeMove(position, game.moves[ply]);
+                    if (!isLegalMove(position, sideToMove, move)) {
+                        ++failed;
+                        break;
+                    }
+                    position.makeMove(move);
+                    sideToMove = opponentOf(sideToMove);
+                    run.push_back({positionKey(position, sideToMove), static_cast<std::uint32_t>(g), ply + 1});
+                }
+            }
+            std::sort(run.begin(), run.end());
+        });
+    }
+    for (std::thread& worker : workers) {
+        worker.join();
+    }
+    if (failed.load() != 0) {
+        std::cerr << failed.load() << " games failed (illegal moves), indexed up to the first illegal move"
+                  << std::endl;
+    }
+
+    std::ofstream out(indexPath, std::ios::binary | std::ios::trunc);
+    if (!out) {
+        std::cerr << "Cannot create " << indexPath << std::endl;
+        return false;
+    }
+    PositionIndexHeader header{};
+    std::memcpy(header.magic, PositionIndexMagic, sizeof(header.magic));
+    header.version = PositionIndexVersion;
+    for (const auto& run : runs) {
+        header.entryCount += run.size();
+    }
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+    // K-way merge of the sorted runs through a small buffer
+    using Cursor = std::pair<const PositionIndexEntry*, const PositionIndexEntry*>;
+    auto later = [](const Cursor& a, const Cursor& b) { return *b.first < *a.first; };
+    std::priority_queue<Cursor, std::vector<Cursor>, decltype(later)> heads(later);
+    for (const auto& run : runs) {
+        if (!run.empty()) {
+            heads.push({run.data(), run.data() + run.size()});
+        }
+    }
+    std::vector<PositionIndexEntry> buffer;
+    buffer.reserve(1 << 16);
+    while (!heads.empty()) {
+        Cursor cursor = heads.top();
+        heads.pop();
+        buffer.push_back(*cursor.first);
+        if (++cursor.first != cursor.second) {
+            heads.push(cursor);
+        }
+        if (buffer.size() == buffer.capacity() || heads.empty()) {
+            out.write(reinterpret_cast<const char*>(buffer.data()),
+                      static_cast<std::streamsize>(buffer.size() * sizeof(PositionIndexEntry)));
+            buffer.clear();
+        }
+    }
+    out.close();
+    if (out.fail()) {
+        std::cerr << "Cannot write " << indexPath << std::endl;
+        return false;
+    }
+    return true;
+}
+
+/**
+ * The PositionIndex class answers "which games reached this position" queries over a memory-mapped
+ * position index.
+ */
+class PositionIndex {
+public:
+    bool open(const std::string& path);
+
+    std::uint64_t entryCount() const {
+        return count;
+    }
+
+    // The postings of key as a [first, last) range into the mapped file
+    std::pair<const PositionIndexEntry*, const PositionIndexEntry*> find(Key key) const;
+
+private:
+    MappedFile file;
+    const PositionIndexEntry* entries = nullptr;
+    std::uint64_t count = 0;
+};
+
+/**
+ * The function maps a position index file and checks its header.
+ *
+ * @return true if the file is a readable position index.
+ */
+bool PositionIndex::open(const std::string& path) {
+    entries = nullptr;
+    count = 0;
+    if (!file.open(path) || file.size() < sizeof(PositionIndexHeader)) {
+        return false;
+    }
+    const PositionIndexHeader* header = reinterpret_cast<const PositionIndexHeader*>(file.data());
+    if (std::memcmp(header->magic, PositionIndexMagic, sizeof(PositionIndexMagic)) != 0 ||
+        header->version != PositionIndexVersion ||
+        header->entryCount != (file.size() - sizeof(PositionIndexHeader)) / sizeof(PositionIndexEntry)) {
+        return false;
+    }
+    entries = reinterpret_cast<const PositionIndexEntry*>(file.data() + sizeof(PositionIndexHeader));
+    count = header->entryCount;
+    return true;
+}
+
+std::pair<const PositionIndexEntry*, const PositionIndexEntry*> PositionIndex::find(Key key) const {
+    auto byKey = [](const PositionIndexEntry& entry, Key value) { return entry.key < value; };
+    const PositionIndexEntry* first = std::lower_bound(entries, entries + count, key, byKey);
+    const PositionIndexEntry* last = first;
+    while (last != entries + count && last->key == key) {
+        ++last;
+    }
+    return {first, last};
+}
+
+/**
+ * The function plays the given moves from the starting position and lists every game of the index
+ * that reached the resulting position, with the time the lookup took.
+ *
+ * @param moves Moves in the coordinate notation of parseMoveText(), e.g. {"a2a4", "e7e5"}.
+ *
+ * @return true if the index could be read and the moves were valid.
+ */
+bool queryPositionIndex(const std::string& indexPath, const std::vector<std::string>& moves) {
+    PositionIndex index;
+    if (!index.open(indexPath)) {
+        std::cerr << "Cannot read position index " << indexPath << std::endl;
+        return false;
+    }
+    ChessBoard chessBoard;
+    PieceColor sideToMove = PieceColor::RED;
+    for (const std::string& move : moves) {
+        int from;
+        int to;
+        PieceType promotion;
+        if (!parseMoveText(move, from, to, promotion) ||
+            !chessBoard.movePiece(rowOf(from), colOf(from), rowOf(to), colOf(to), promotion)) {
+            std::cerr << "Invalid move '" << move << "'" << std::endl;
+            return false;
+        }
+        sideToMove = opponentOf(sideToMove);
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    auto postings = index.find(positionKey(chessBoard.getPosition(), sideToMove));
+    double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
 
+    std::size_t matches = static_cast<std::size_t>(postings.second - postings.first);
+    std::size_t shown = 0;
+    for (const PositionIndexEntry* entry = postings.first; entry != postings.second && shown < 20; ++entry, ++shown) {
+        std::cout << "game " << entry->game << " ply " << entry->ply << "\n";
+    }
+    if (matches > shown) {
+        std::cout << "... " << matches - shown << " more\n";
+    }
+    std::cout << matches << " postings found in " << std::fixed << std::setprecision(3) << elapsed * 1e3
+              << " ms" << std::endl;
+    return true;
+}
 
 /**
- * The ChessBoard constructor initializes the chessboard with pieces, including pawns, rooks, knights,
- * bishops, queens, and kings.
- */
-/**
- * The ChessBoard constructor initializes the chessboard with pieces, including pawns, rooks, knights,
- * bishops, queens, and kings.
+ * The function evaluates every position of every game in an archive and prints evaluation
+ * throughput together with the pawn hash table statistics. A game with an illegal move is evaluated
+ * up to that move and counted as failed.
+ *
+ * @return true if the archive could be read and every game was legal.
  */
-// Implementation of member functions for ChessBoard
-ChessBoard::ChessBoard() {
-    // Initialize the chessboard with pieces
-    // Initialize the chessboard with pieces
-    board.resize(8, std::vector<ChessPiece*>(8, nullptr));
-
-    // Initialize pawns
-    for (int i = 0; i < 8; ++i) {
-        board[1][i] = new Pawn(PieceColor::RED);
-        board[6][i] = new Pawn(PieceColor::BLUE);
+bool printEvaluationStats(const std::string& archivePath) {
+    GameArchive archive;
+    if (!archive.open(archivePath)) {
+        std::cerr << "Cannot read archive " << archivePath << std::endl;
+        return false;
     }
+    const Position start = ChessBoard().getPosition();
+    PawnHashTable pawnTable;
+    std::uint64_t positions = 0;
+    std::uint64_t failed = 0;
+    std::int64_t checksum = 0;
+    double elapsed = 0.0;
 
-    // Initialize rooks
-    board[0][0] = new Rook(PieceColor::RED);
-    board[0][7] = new Rook(PieceColor::RED);
-    board[7][0] = new Rook(PieceColor::BLUE);
-    board[7][7] = new Rook(PieceColor::BLUE);
-    
-    //Initialize Knights
-    board[0][1] = new Knight(PieceColor::RED);
-    board[0][6] = new Knight(PieceColor::RED);
-    board[7][1] = new Knight(PieceColor::BLUE);
-    board[7][6] = new Knight(PieceColor::BLUE);
+    // Each game is replayed and checked first, so only the evaluation itself is timed
+    std::vector<Position> gamePositions;
+    std::vector<PieceColor> gameSides;
+    for (std::uint64_t g = 0; g < archive.gameCount(); ++g) {
+        ArchivedGame game = archive.game(g);
+        Position position = start;
+        PieceColor sideToMove = PieceColor::RED;
+        gamePositions.assign(1, position);
+        gameSides.assign(1, sideToMove);
+        for (std::uint32_t ply = 0; ply < game.moveCount; ++ply) {
+            const Move move = decodeMove(position, game.moves[ply]);
+            if (!isLegalMove(position, sideToMove, move)) {
+                ++failed;
+                break;
+            }
+            position.makeMove(move);
+            sideToMove = opponentOf(sideToMove);
+            gamePositions.push_back(position);
+            gameSides.push_back(sideToMove);
+        }
+        auto begin = std::chrono::steady_clock::now();
+        for (std::size_t i = 0; i < gamePositions.size(); ++i) {
+            checksum += evaluate(gamePositions[i], gameSides[i], pawnTable);
+        }
+        elapsed += std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+        positions += gamePositions.size();
+    }
 
-   //Initialize Bishops
-    board[0][2] = new Bishop(PieceColor::RED);
-    board[0][5] = new Bishop(PieceColor::RED);
-    board[7][2] = new Bishop(PieceColor::BLUE);
-    board[7][5] = new Bishop(PieceColor::BLUE);
-    
-    //Initialize Queens
-    board[0][3] = new Queen(PieceColor::RED);
-    board[7][3] = new Queen(PieceColor::BLUE);
-    
-    //Initialize Kings
-    board[0][4] = new King(PieceColor::RED);
-    board[7][4] = new King(PieceColor::BLUE);
+    std::cout << std::fixed << std::setprecision(3)
+              << "Positions evaluated: " << positions << " (checksum " << checksum << ")\n"
+              << "Time:                " << elapsed * 1e3 << " ms, "
+              << positions / std::max(elapsed, 1e-9) / 1e6 << " M positions/s\n"
+              << "Pawn table probes:   " << pawnTable.probes() << ", hits: " << pawnTable.hits()
+              << ", hit rate: " << pawnTable.hitRate() * 100 << "%\n"
+              << "Games failed:        " << failed << " (illegal moves, evaluated up to the first one)" << std::endl;
+    return failed == 0;
+}
 
-    
+// Positions of the search benchmark, as moves from the starting position in coordinate notation
+const char* const BenchmarkPositions[] = {
+    "",
+    "e2e4 e7e5 g1f3 b8c6 f1c4 g8f6",
+    "d2d4 d7d5 c2c4 e7e6 b1c3 g8f6 c1g5 f8e7",
+    "e2e4 c7c5 g1f3 d7d6 d2d4 c5d4 f3d4 g8f6 b1c3 a7a6",
+    "e2e4 d7d5 e4d5 d8d5 b1c3 d5a5 d2d4 g8f6 g1f3 c8f5 f1c4 e7e6",
+    "d2d4 g8f6 c2c4 g7g6 b1c3 f8g7 e2e4 d7d6 g1f3 b8d7 f1e2 e7e5",
+};
 
-}
 /**
- * The function `isPathClear` checks if the path between two positions on a chessboard is clear of
- * obstructions.
+ * The function plays moves in coordinate notation from the starting position.
+ *
+ * @param sideToMove Set to the color to move after the moves.
+ *
+ * @return false if one of the moves is not accepted by ChessBoard::movePiece.
  */
+bool playMoves(ChessBoard& chessBoard, const std::string& moves, PieceColor& sideToMove) {
+    std::istringstream tokens(moves);
+    std::string token;
+    sideToMove = PieceColor::RED;
+    while (tokens >> token) {
+        int from;
+        int to;
+        PieceType promotion;
+        if (!parseMoveText(token, from, to, promotion) ||
+            !chessBoard.movePiece(rowOf(from), colOf(from), rowOf(to), colOf(to), promotion)) {
+            return false;
+        }
+        sideToMove = opponentOf(sideToMove);
+    }
+    return true;
+}
 
 /**
- * The destructor of the ChessBoard class cleans up dynamically allocated ChessPiece objects.
+ * The function searches every benchmark position to a fixed depth, once with all selective search
+ * features, once without each feature in turn and once with none, and prints nodes, time to depth
+ * and the pawn hash table probes and hit rate for each configuration.
  */
-ChessBoard::~ChessBoard() {
-    // Clean up dynamically allocated ChessPiece objects
-    for (auto& row : board) {
-        for (auto& piece : row) {
-            delete piece;
+bool benchmarkSearch(int depth) {
+    struct Configuration {
+        const char* name;
+        SearchParams params;
+    };
+    std::vector<Configuration> configurations;
+    SearchParams all;
+    SearchParams none;
+    none.nullMove = none.lateMoveReductions = none.futility = none.reverseFutility = none.checkExtensions =
+        none.transpositionTable = false;
+    configurations.push_back({"all features", all});
+    configurations.push_back({"no null move", all});
+    configurations.back().params.nullMove = false;
+    configurations.push_back({"no late move reductions", all});
+    configurations.back().params.lateMoveReductions = false;
+    configurations.push_back({"no futility", all});
+    configurations.back().params.futility = false;
+    configurations.push_back({"no reverse futility", all});
+    configurations.back().params.reverseFutility = false;
+    configurations.push_back({"no check extensions", all});
+    configurations.back().params.checkExtensions = false;
+    configurations.push_back({"no transposition table", all});
+    configurations.back().params.transpositionTable = false;
+    configurations.push_back({"no selective features", none});
+
+    std::vector<Position> positions;
+    std::vector<PieceColor> sides;
+    for (const char* moves : BenchmarkPositions) {
+        ChessBoard chessBoard;
+        PieceColor sideToMove;
+        if (!playMoves(chessBoard, moves, sideToMove)) {
+            std::cerr << "Invalid benchmark position: " << moves << std::endl;
+            return false;
+        }
+        positions.push_back(chessBoard.getPosition());
+        sides.push_back(sideToMove);
+    }
+
+    std::cout << "Search benchmark, depth " << depth << ", " << positions.size() << " positions\n"
+              << std::left << std::setw(26) << "configuration" << std::right << std::setw(14) << "nodes"
+              << std::setw(12) << "time (ms)" << std::setw(12) << "knodes/s" << std::setw(10) << "nodes %"
+              << std::setw(10) << "time %" << std::setw(14) << "pawn probes" << std::setw(12) << "pawn hit %"
+              << std::endl;
+    std::uint64_t baselineNodes = 0;
+    double baselineTime = 0.0;
+    for (const Configuration& configuration : configurations) {
+        std::uint64_t nodes = 0;
+        std::uint64_t pawnProbes = 0;
+        std::uint64_t pawnHits = 0;
+        double seconds = 0.0;
+        for (std::size_t i = 0; i < positions.size(); ++i) {
+            Searcher searcher(configuration.params);
+            SearchResult result = searcher.search(positions[i], sides[i], depth);
+            nodes += result.nodes;
+            seconds += result.seconds;
+            pawnProbes += searcher.pawnTable().probes();
+            pawnHits += searcher.pawnTable().hits();
+        }
+        if (&configuration == &configurations.front()) {
+            baselineNodes = nodes;
+            baselineTime = seconds;
+        }
+        std::cout << std::left << std::setw(26) << configuration.name << std::right << std::setw(14) << nodes
+                  << std::fixed << std::setprecision(1) << std::setw(12) << seconds * 1e3 << std::setw(12)
+                  << nodes / std::max(seconds, 1e-9) / 1e3 << std::setw(10) << 100.0 * nodes / std::max<std::uint64_t>(baselineNodes, 1)
+                  << std::setw(10) << 100.0 * seconds / std::max(baselineTime, 1e-9) << std::setw(14) << pawnProbes
+                  << std::setw(12) << 100.0 * pawnHits / std::max<std::uint64_t>(pawnProbes, 1) << std::endl;
+    }
+    return true;
+}
+
+// Print the lines of an analysis, one per line with score and principal variation, or the game result
+void printAnalysis(std::ostream& out, const AnalysisResult& result) {
+    if (result.checkmate || result.stalemate) {
+        out << "  no legal moves: " << (result.checkmate ? "checkmate, the side to move has lost" : "stalemate, draw")
+            << '\n';
+        return;
+    }
+    for (std::size_t i = 0; i < result.lines.size(); ++i) {
+        out << "  " << (i + 1) << ". depth " << result.depth << " score " << std::showpos << result.lines[i].score
+            << std::noshowpos << " pv";
+        for (const Move move : result.lines[i].pv) {
+            out << ' ' << moveText(move);
         }
+        out << '\n';
     }
 }
 
 /**
- * The function displays the current state of a chessboard with colored pieces.
+ * The function runs a multi-PV analysis. Given a FEN it analyzes that position and prints the lines
+ * after each depth as they are found; otherwise it analyzes the benchmark positions in parallel on
+ * all hardware threads.
  */
-void ChessBoard::display() const {
-    std::cout << "    A  B  C  D  E  F  G  H" << std::endl;
-    for (int i = 0; i < 8; ++i) {
-        std::cout << i + 1 << " |";
-        for (int j = 0; j < 8; ++j) {
-            ChessPiece* piece = board[i][j];
-            char symbol = (piece) ? piece->getSymbol() : '.';
-
-            // Add color to the displayed piece based on its color
-            if (piece) {
-                std::cout << (piece->getColor() == PieceColor::RED ? "\033[1;31m" : "\033[1;34m");
-                std::cout << std::setw(2) << symbol << "\033[0m" << '|';
-            } else {
-                std::cout << std::setw(2) << symbol << '|';
-            }
+bool runAnalysis(int depth, int lineCount, const std::string& fen) {
+    if (!fen.empty()) {
+        Position position;
+        PieceColor sideToMove;
+        if (!parseFen(fen, position, sideToMove)) {
+            std::cerr << "Invalid FEN: " << fen << std::endl;
+            return false;
+        }
+        Searcher searcher;
+        AnalysisResult result = searcher.analyze(position, sideToMove, depth, lineCount, [](const AnalysisResult& update) {
+            printAnalysis(std::cout, update);
+            std::cout << "  " << update.nodes << " nodes, " << std::fixed << std::setprecision(1)
+                      << update.seconds * 1e3 << " ms" << std::endl;
+        });
+        if (result.checkmate || result.stalemate) {
+            printAnalysis(std::cout, result);
+            std::cout << std::flush;
+            return true;
         }
-        std::cout << std::endl;
+        return !result.lines.empty();
     }
 
+    std::vector<Position> positions;
+    std::vector<PieceColor> sides;
+    for (const char* moves : BenchmarkPositions) {
+        ChessBoard chessBoard;
+        PieceColor sideToMove;
+        if (!playMoves(chessBoard, moves, sideToMove)) {
+            std::cerr << "Invalid benchmark position: " << moves << std::endl;
+            return false;
+        }
+        positions.push_back(chessBoard.getPosition());
+        sides.push_back(sideToMove);
+    }
+    const unsigned threads = std::max(1u, std::thread::hardware_concurrency());
+    auto start = std::chrono::steady_clock::now();
+    std::vector<AnalysisResult> results = analyzePositions(positions, sides, depth, lineCount, threads);
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::uint64_t nodes = 0;
+    for (std::size_t i = 0; i < results.size(); ++i) {
+        std::cout << toFen(positions[i], sides[i]) << '\n';
+        printAnalysis(std::cout, results[i]);
+        nodes += results[i].nodes;
+    }
+    std::cout << positions.size() << " positions, " << lineCount << " lines, depth " << depth << ", " << threads
+              << " threads: " << nodes << " nodes in " << std::fixed << std::setprecision(1) << seconds * 1e3
+              << " ms" << std::endl;
+    return true;
 }
 
 /**
- * The function returns the ChessPiece object at the specified position on the chess board.
- * 
- * @param row The row parameter represents the row index of the chessboard. It specifies the vertical
- * position of the chess piece on the board. The valid range for the row parameter is from 0 to 7,
- * inclusive.
- * @param col The "col" parameter represents the column index of the chessboard. It is used to specify
- * the column position of the chess piece that we want to retrieve from the chessboard.
- * 
- * @return a pointer to a ChessPiece object.
+ * The function prints the perft count below each legal move of a position (the starting position
+ * if fen is empty), followed by the total and the number of nodes per second.
  */
-ChessPiece* ChessBoard::getPiece(int row, int col) const {
-    // Return the ChessPiece object at the specified position
-    if (row >= 0 && row < 8 && col >= 0 && col < 8) {
-        return board[row][col];
+bool runPerft(int depth, const std::string& fen) {
+    Position position = ChessBoard().getPosition();
+    PieceColor sideToMove = PieceColor::RED;
+    if (!fen.empty() && !parseFen(fen, position, sideToMove)) {
+        std::cerr << "Invalid FEN: " << fen << std::endl;
+        return false;
+    }
+    if (depth < 1) {
+        // The tree of depth 0 is the position itself
+        std::cout << "Nodes: 1" << std::endl;
+        return true;
+    }
+    MoveList moves;
+    if (sideToMove == PieceColor::RED) {
+        generateLegalMoves<PieceColor::RED>(position, moves);
     } else {
-        return nullptr;
+        generateLegalMoves<PieceColor::BLUE>(position, moves);
+    }
+    auto start = std::chrono::steady_clock::now();
+    std::uint64_t total = 0;
+    UndoInfo undo;
+    for (const Move move : moves) {
+        std::uint64_t nodes = 1;
+        if (depth > 1) {
+            position.makeMove(move, undo);
+            nodes = sideToMove == PieceColor::RED ? perft<PieceColor::BLUE>(position, depth - 1)
+                                                  : perft<PieceColor::RED>(position, depth - 1);
+            position.unmakeMove(move, undo);
+        }
+        std::cout << moveText(move) << ": " << nodes << '\n';
+        total += nodes;
     }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::cout << "Nodes: " << total << " in " << std::fixed << std::setprecision(1) << seconds * 1e3 << " ms, "
+              << std::setprecision(0) << total / std::max(seconds, 1e-9) << " nodes/s" << std::endl;
+    return true;
+}
+
+/* The code below ingests PGN files. The file is memory-mapped and tokenized in place with
+std::string_view, so the game text is never copied. SAN moves are resolved against the legal moves
+of a live ChessBoard. Large files are split at game boundaries into one chunk per thread. */
+
+// One game read from a PGN file
+struct PgnGame {
+    std::vector<std::uint16_t> moves;
+    GameResult result = GameResult::UNKNOWN;
+};
+
+// The games parsed from one chunk of a PGN file and the counters of that chunk
+struct PgnChunkResult {
+    std::vector<PgnGame> games;
+    std::uint64_t plies = 0;
+    std::uint64_t failedGames = 0;
+};
+
+inline bool isPgnSpace(char c) {
+    return c == ' ' || c == '\t' || c == '\n' || c == '\r';
 }
 
+inline GameResult parseResult(std::string_view text) {
+    if (text == "1-0") {
+        return GameResult::RED_WINS;
+    }
+    if (text == "0-1") {
+        return GameResult::BLUE_WINS;
+    }
+    return text == "1/2-1/2" ? GameResult::DRAW : GameResult::UNKNOWN;
+}
 
 /**
- * The function `isPathClear` checks if the path between two positions on a chessboard is clear for a
- * chess piece to move.
- * 
- * @param rowFrom The starting row of the chess piece's position.
- * @param colFrom The parameter `colFrom` represents the starting column of the chess piece's position.
- * @param rowTo The parameter "rowTo" represents the row number of the destination position on the
- * chessboard.
- * @param colTo The parameter `colTo` represents the column index of the destination position on the
- * chessboard.
- * 
- * @return a boolean value. It returns true if the path from the starting position (rowFrom, colFrom)
- * to the ending position (rowTo, colTo) is clear, and false otherwise.
+ * The function resolves a move in standard algebraic notation (e.g. "Nf3", "exd5", "R1a3+", "O-O",
+ * "e8=Q") to the single legal move of currentPlayer on chessBoard that it describes.
+ *
+ * @return true if exactly one legal move matches.
  */
-bool ChessPiece::isPathClear(int rowFrom, int colFrom, int rowTo, int colTo) const {
-     int rowDiff = rowTo - rowFrom;
-    int colDiff = colTo - colFrom;
-
-    auto isValidPosition = [](int row, int col) {
-        return row >= 0 && row < 8 && col >= 0 && col < 8;
-    };
+bool resolveSan(std::string_view san, const ChessBoard& chessBoard, PieceColor currentPlayer, Move& move) {
+    while (!san.empty() && (san.back() == '+' || san.back() == '#' || san.back() == '!' || san.back() == '?')) {
+        san.remove_suffix(1);
+    }
+    const Position& position = chessBoard.getPosition();
+    MoveList legalMoves;
+    if (currentPlayer == PieceColor::RED) {
+        generateLegalMoves<PieceColor::RED>(position, legalMoves);
+    } else {
+        generateLegalMoves<PieceColor::BLUE>(position, legalMoves);
+    }
 
-    // Check if the path is clear horizontally
-    if (rowDiff == 0) {
-        int colStep = (colDiff > 0) ? 1 : -1;
-        for (int col = colFrom + colStep; col != colTo; col += colStep) {
-            if (!isValidPosition(rowFrom, col) || board->getPiece(rowFrom, col)) {
-                return false; // Obstruction in the path or out of bounds
+    if (san == "O-O" || san == "0-0" || san == "O-O-O" || san == "0-0-0") {
+        const int kingCol = san.size() == 3 ? 6 : 2;
+        int matches = 0;
+        for (const Move candidate : legalMoves) {
+            if (candidate.type() == CASTLING && colOf(candidate.to()) == kingCol) {
+                move = candidate;
+                ++matches;
             }
         }
+        return matches == 1;
     }
-    // Check if the path is clear vertically
-    else if (colDiff == 0) {
-        int rowStep = (rowDiff > 0) ? 1 : -1;
-        for (int row = rowFrom + rowStep; row != rowTo; row += rowStep) {
-            if (!isValidPosition(row, colFrom) || board->getPiece(row, colFrom)) {
-                return false; // Obstruction in the path or out of bounds
-            }
-        }
+
+    // A promotion ends with the new piece, with or without '='
+    PieceType promotion = NO_PIECE_TYPE;
+    if (san.size() >= 2 && std::string_view("NBRQ").find(san.back()) != std::string_view::npos) {
+        promotion = pieceTypeOf(san.back());
+        san.remove_suffix(san[san.size() - 2] == '=' ? 2 : 1);
     }
-    // Check if the path is clear diagonally
-    else if (std::abs(rowDiff) == std::abs(colDiff)) {
-        int rowStep = (rowDiff > 0) ? 1 : -1;
-        int colStep = (colDiff > 0) ? 1 : -1;
+    if (san.size() < 2) {
+        return false;
+    }
+    PieceType type = PAWN;
+    if (std::string_view("NBRQK").find(san[0]) != std::string_view::npos) {
+        type = pieceTypeOf(san[0]);
+        san.remove_prefix(1);
+    }
+    if (san.size() < 2 || (promotion != NO_PIECE_TYPE && type != PAWN)) {
+        return false;
+    }
+    int toCol = san[san.size() - 2] - 'a';
+    int toRow = san[san.size() - 1] - '1';
+    if (!isOnBoard(toRow, toCol)) {
+        return false;
+    }
+    san.remove_suffix(2);
 
-        for (int i = 1; i < std::abs(rowDiff); ++i) {
-            int newRow = rowFrom + i * rowStep;
-            int newCol = colFrom + i * colStep;
-            if (!isValidPosition(newRow, newCol) || board->getPiece(newRow, newCol)) {
-                return false; // Obstruction in the path or out of bounds
-            }
+    // What is left is the optional origin file and rank and the capture mark
+    int fromCol = -1;
+    int fromRow = -1;
+    bool capture = false;
+    for (char c : san) {
+        if (c >= 'a' && c <= 'h') {
+            fromCol = c - 'a';
+        } else if (c >= '1' && c <= '8') {
+            fromRow = c - '1';
+        } else if (c == 'x') {
+            capture = true;
+        } else {
+            return false;
         }
-    } else {
-        // Invalid path
-        return false;
+    }
+    // A pawn stays on its file unless it captures
+    if (type == PAWN && !capture) {
+        fromCol = toCol;
     }
 
-    // Path is clear
-    return true;
+    const int to = squareOf(toRow, toCol);
+    int matches = 0;
+    for (const Move candidate : legalMoves) {
+        if (candidate.to() == to && position.pieceTypeOn(candidate.from()) == type && candidate.type() != CASTLING &&
+            (fromCol < 0 || colOf(candidate.from()) == fromCol) && (fromRow < 0 || rowOf(candidate.from()) == fromRow) &&
+            (candidate.type() == PROMOTION ? candidate.promotion() == promotion : promotion == NO_PIECE_TYPE)) {
+            move = candidate;
+            ++matches;
+        }
+    }
+    return matches == 1;
 }
 
 /**
- * The movePiece function in the ChessBoard class checks if a move is valid and performs the move if it
- * is, capturing the opponent's king if necessary.
- * 
- * @param rowFrom The row index of the square from which the ChessPiece is being moved.
- * @param colFrom The parameter "colFrom" represents the column index of the square from which the
- * chess piece is being moved.
- * @param rowTo The parameter "rowTo" represents the row index of the destination square where the
- * chess piece is being moved to.
- * @param colTo The parameter "colTo" represents the column index of the destination square where the
- * ChessPiece is being moved to.
- * 
- * @return The `movePiece` function returns a boolean value indicating whether the move was successful
- * or not. The `isPlayerKingCaptured` function returns a boolean value indicating whether the player's
- * king is captured or not. The `isGameOver` function returns a boolean value indicating whether the
- * game is over or not. The `isSquareUnderThreat` function returns a boolean value indicating whether a
- * given square
+ * The function parses the games in text, replaying each move on a ChessBoard. Tag pairs other than
+ * the result, comments, recursive variations, NAGs and move numbers are skipped. A game with a move
+ * that cannot be resolved is counted as failed and left out.
  */
-bool ChessBoard::movePiece(int rowFrom, int colFrom, int rowTo, int colTo) {
-    // Move the ChessPiece from (rowFrom, colFrom) to (rowTo, colTo) if (rowFrom >= 0 && rowFrom < 8 && colFrom >= 0 && colFrom < 8 &&
-        if (rowFrom >= 0 && rowFrom < 8 && colFrom >= 0 && colFrom < 8 &&
-        rowTo >= 0 && rowTo < 8 && colTo >= 0 && colTo < 8 &&
-        board[rowFrom][colFrom] && board[rowFrom][colFrom]->isValidMove(rowFrom, colFrom, rowTo, colTo)) {
-        
-        ChessPiece* sourcePiece = board[rowFrom][colFrom];
-        ChessPiece* destinationPiece = board[rowTo][colTo];
-
-        // Check if the destination square is empty or contains a piece of the opposite color
-        if (!destinationPiece || destinationPiece->getColor() != sourcePiece->getColor()) {
-            // Perform the move if it's a valid move
-            ChessPiece* temp = board[rowTo][colTo];
-            board[rowTo][colTo] = board[rowFrom][colFrom];
-            board[rowFrom][colFrom] = nullptr;
-            delete temp;
+void parsePgnChunk(std::string_view text, PgnChunkResult& result) {
+    std::unique_ptr<ChessBoard> chessBoard;
+    PieceColor currentPlayer = PieceColor::RED;
+    PgnGame game;
+    bool inGame = false;
+    bool failed = false;
 
-            // Check if the moved piece is a king
-            if (dynamic_cast<King*>(board[rowTo][colTo])) {
-        // If the king is captured, end the game
-        std::cout << "Player "
-                  << (sourcePiece->getColor() == PieceColor::RED ? "RED" : "BLUE")
-                  << " has lost the game. King is captured!" << std::endl;
-        
-        // Set the game state to over
-        gameOver = true;
-        
-        
-    }
+    auto startGame = [&]() {
+        chessBoard = std::make_unique<ChessBoard>();
+        currentPlayer = PieceColor::RED;
+        game = PgnGame();
+        inGame = true;
+        failed = false;
+    };
+    auto finishGame = [&]() {
+        if (!inGame) {
+            return;
+        }
+        if (failed) {
+            ++result.failedGames;
+        } else {
+            result.plies += game.moves.size();
+            result.games.push_back(std::move(game));
+        }
+        inGame = false;
+    };
 
-            return true;
+    std::size_t pos = 0;
+    bool sawMoves = false;
+    while (pos < text.size()) {
+        char c = text[pos];
+        if (isPgnSpace(c)) {
+            ++pos;
+        } else if (c == '[') {
+            // A tag pair; the first tag after movetext starts a new game
+            std::size_t end = text.find(']', pos);
+            end = (end == std::string_view::npos) ? text.size() : end + 1;
+            if (!inGame || sawMoves) {
+                finishGame();
+                startGame();
+                sawMoves = false;
+            }
+            std::string_view tag = text.substr(pos, end - pos);
+            if (tag.substr(0, 8) == "[Result ") {
+                std::size_t open = tag.find('"');
+                std::size_t close = tag.rfind('"');
+                if (open != std::string_view::npos && close > open) {
+                    game.result = parseResult(tag.substr(open + 1, close - open - 1));
+                }
+            }
+            pos = end;
+        } else if (c == '{') {
+            std::size_t end = text.find('}', pos);
+            pos = (end == std::string_view::npos) ? text.size() : end + 1;
+        } else if (c == ';' || (c == '%' && (pos == 0 || text[pos - 1] == '\n'))) {
+            std::size_t end = text.find('\n', pos);
+            pos = (end == std::string_view::npos) ? text.size() : end + 1;
+        } else if (c == '(') {
+            int depth = 0;
+            for (; pos < text.size(); ++pos) {
+                if (text[pos] == '(') {
+                    ++depth;
+                } else if (text[pos] == ')' && --depth == 0) {
+                    ++pos;
+                    break;
+                } else if (text[pos] == '{') {
+                    std::size_t end = text.find('}', pos);
+                    pos = (end == std::string_view::npos) ? text.size() - 1 : end;
+                }
+            }
         } else {
-            std::cout << "Invalid move. Cannot capture a piece of the same color." << std::endl;
-            return false;
+            std::size_t end = pos;
+            while (end < text.size() && !isPgnSpace(text[end]) && std::string_view("{}()[];").find(text[end]) == std::string_view::npos) {
+                ++end;
+            }
+            if (end == pos) {
+                ++pos; // Stray closing bracket
+                continue;
+            }
+            std::string_view token = text.substr(pos, end - pos);
+            pos = end;
+            if (token[0] == '$') {
+                continue;
+            }
+            if (token == "1-0" || token == "0-1" || token == "1/2-1/2" || token == "*") {
+                if (inGame) {
+                    game.result = parseResult(token);
+                }
+                finishGame();
+                sawMoves = false;
+                continue;
+            }
+            // Strip a move number such as "12." or "12..." which may be glued to the move
+            std::size_t skip = 0;
+            while (skip < token.size() && (std::isdigit(static_cast<unsigned char>(token[skip])) || token[skip] == '.')) {
+                ++skip;
+            }
+            if (skip > 0 && (skip == token.size() || token[skip - 1] == '.')) {
+                token.remove_prefix(skip);
+            }
+            if (token.empty()) {
+                continue;
+            }
+            if (!inGame) {
+                startGame();
+            }
+            sawMoves = true;
+            Move move;
+            if (failed || !resolveSan(token, *chessBoard, currentPlayer, move)) {
+                failed = true;
+                continue;
+            }
+            chessBoard->movePiece(move);
+            game.moves.push_back(encodeMove(move));
+            currentPlayer = opponentOf(currentPlayer);
         }
-    } else {
-        return false;
-    } 
+    }
+    finishGame();
 }
 
 /**
- * The function checks if the player's king is captured by iterating through the chess board and
- * searching for the king piece.
- * 
- * @param playerColor The parameter `playerColor` is of type `PieceColor` and represents the color of
- * the player whose king we want to check if it is captured.
- * 
- * @return a boolean value. It returns true if the player's king is captured, and false if the player's
- * king is still on the board.
+ * The function returns the offset of the first game that starts at or after pos: a '[' at the
+ * start of a line that follows a blank line.
  */
-bool ChessBoard::isPlayerKingCaptured(PieceColor playerColor) const {
-    // Iterate through the board to check if the player's king is captured
-    /* The above code is checking if the player's king is still on the chess board. It iterates through
-    each position on the board and checks if there is a chess piece at that position. If there is a
-    piece and it is a king ('K') of the same color as the player, it returns false, indicating that
-    the king is still on the board. */
-    for (int i = 0; i < 8; ++i) {
-        for (int j = 0; j < 8; ++j) {
-            ChessPiece* piece = board[i][j];
-            if (piece && piece->getSymbol() == 'K' && piece->getColor() == playerColor) {
-                // The player's king is still on the board
-                return false;
-            }
+std::size_t findPgnGameStart(std::string_view text, std::size_t pos) {
+    while (pos < text.size()) {
+        std::size_t bracket = text.find("\n[", pos);
+        if (bracket == std::string_view::npos) {
+            return text.size();
+        }
+        std::size_t previous = bracket;
+        while (previous > 0 && (text[previous - 1] == '\r' || text[previous - 1] == ' ' || text[previous - 1] == '\t')) {
+            --previous;
         }
+        if (previous == 0 || text[previous - 1] == '\n') {
+            return bracket + 1;
+        }
+        pos = bracket + 1;
     }
-    // The player's king is not found, indicating it is captured
-    return true;
+    return text.size();
 }
 
 /**
- * The function checks if the game is over by determining if either player's king has been captured.
- * 
- * @return the value of the variable "gameOver", which is a boolean value indicating whether the game
- * is over or not.
+ * The function ingests a PGN file with threadCount threads (0 for every core), optionally writes
+ * the games to an archive, and prints the ingest throughput.
+ *
+ * @return true if the file could be read and the archive, if any, written.
  */
-bool ChessBoard::isGameOver()  {
-    
-    
-   if (isPlayerKingCaptured(PieceColor::RED) || isPlayerKingCaptured(PieceColor::BLUE)) {
-        gameOver = true;
-    } else {
-       
-       gameOver = false;
-}
-   return gameOver;
-   
-}
+bool importPgn(const std::string& pgnPath, const std::string& archivePath, unsigned threadCount = 0) {
+    auto start = std::chrono::steady_clock::now();
+    MappedFile file;
+    if (!file.open(pgnPath)) {
+        std::cerr << "Cannot open " << pgnPath << std::endl;
+        return false;
+    }
+    const std::string_view text(file.data(), file.size());
+    if (threadCount == 0) {
+        threadCount = std::max(1u, std::thread::hardware_concurrency());
+    }
 
+    std::vector<std::size_t> bounds = {0};
+    for (unsigned t = 1; t < threadCount; ++t) {
+        bounds.push_back(std::max(bounds.back(), findPgnGameStart(text, text.size() * t / threadCount)));
+    }
+    bounds.push_back(text.size());
 
-bool ChessBoard::isSquareUnderThreat(int row, int col, PieceColor currentPlayer) const {
-    // Check if any opponent piece can attack the given square
-     /* The above code is checking if there is any valid move for the current player in a chess game.
-     It iterates through each position on the chess board (8x8) and checks if there is a chess piece
-     at that position. If there is a piece and it belongs to the opponent of the current player, it
-     calls the `isValidMove()` function of that piece to check if it can move to the specified row
-     and column. If a valid move is found, the function returns true. */
-     for (int i = 0; i < 8; ++i) {
-        for (int j = 0; j < 8; ++j) {
-            ChessPiece* piece = board[i][j];
-            if (piece && piece->getColor() != currentPlayer && piece->isValidMove(i, j, row, col)) {
-                return true;
+    std::vector<PgnChunkResult> chunks(threadCount);
+    std::vector<std::thread> workers;
+    for (unsigned t = 0; t < threadCount; ++t) {
+        workers.emplace_back([&, t]() {
+            parsePgnChunk(text.substr(bounds[t], bounds[t + 1] - bounds[t]), chunks[t]);
+        });
+    }
+    for (std::thread& worker : workers) {
+        worker.join();
+    }
+
+    std::uint64_t games = 0;
+    std::uint64_t plies = 0;
+    std::uint64_t failed = 0;
+    for (const PgnChunkResult& chunk : chunks) {
+        games += chunk.games.size();
+        plies += chunk.plies;
+        failed += chunk.failedGames;
+    }
+    if (!archivePath.empty()) {
+        GameArchiveWriter writer;
+        if (!writer.open(archivePath)) {
+            std::cerr << "Cannot create " << archivePath << std::endl;
+            return false;
+        }
+        for (const PgnChunkResult& chunk : chunks) {
+            for (const PgnGame& game : chunk.games) {
+                writer.addGame(game.moves.data(), static_cast<std::uint32_t>(game.moves.size()), game.result);
             }
         }
+        if (!writer.close()) {
+            std::cerr << "Cannot write " << archivePath << std::endl;
+            return false;
+        }
     }
-    return false;
+    double seconds = std::max(std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count(), 1e-9);
+    std::cout << std::fixed << std::setprecision(3)
+              << "Games: " << games << " imported, " << failed << " failed (unsupported or illegal moves), "
+              << plies << " plies\n"
+              << "Time:  " << seconds * 1e3 << " ms with " << threadCount << " threads, "
+              << file.size() / seconds / 1e6 << " MB/s, " << file.size() / seconds * 60 / 1e9 << " GB/min" << std::endl;
+    return true;
 }
 
-bool ChessBoard::canEscapeCheck(int kingRow, int kingCol, PieceColor currentPlayer) const {
-    // Check if the king can move to any square that is not under threat
-   /* The above code is checking if there is at least one square on a chessboard that is not under
-   threat from the current player's pieces. It does this by iterating through all the squares on the
-   board and calling the function `isSquareUnderThreat` to check if each square is under threat. If
-   it finds a square that is not under threat, it returns `true` indicating that the king can escape
-   check. */
-    for (int i = 0; i < 8; ++i) {
-        for (int j = 0; j < 8; ++j) {
-            if (!isSquareUnderThreat(i, j, currentPlayer)) {
-                // If there is at least one square not under threat, the king can escape check
-                return true;
-            }
-        }
+#if !defined(_WIN32)
+/* The code below broadcasts a live game to local spectators over pipes or Unix sockets. Each move is
+sent as a small delta frame listing the squares that changed and the resulting position hash, so a
+spectator can check it stayed in sync. Frames published between two flushes are batched and written
+to every subscriber with one non-blocking writev each. Only a spectator that joins late is sent a
+snapshot frame with the whole board, rendered once per position and shared by all late joiners.
+
+Frame layout (little-endian): u16 payload length, u8 frame type, then the payload.
+  DELTA:    u32 sequence, u64 position key, u8 count, count * (u8 square, u8 piece code)
+  SNAPSHOT: u32 sequence, u64 position key, 64 piece codes, rendered board text
+A piece code is 0 for an empty square, 1-6 for RED pawn to king and 7-12 for BLUE pawn to king. */
+
+enum class FrameType : std::uint8_t {
+    DELTA = 1,
+    SNAPSHOT = 2
+};
+
+inline std::uint8_t pieceCode(const Position& position, int square) {
+    if (position.isEmpty(square)) {
+        return 0;
     }
-    return false;
+    return static_cast<std::uint8_t>(1 + position.pieceTypeOn(square) +
+                                     (position.colorOn(square) == PieceColor::BLUE ? PIECE_TYPE_NB : 0));
 }
 
 /**
- * The code checks if a move puts the king in check and if the current player is in checkmate.
- * 
- * @param fromRow The row index of the piece's current position on the chessboard.
- * @param fromCol The column index of the starting position of the piece being moved.
- * @param toRow The parameter "toRow" represents the row number of the destination square where the
- * piece is being moved to.
- * @param toCol The parameter "toCol" represents the column index of the destination square where the
- * piece is being moved to.
- * @param currentPlayer The parameter "currentPlayer" represents the color of the current player. It is
- * of type "PieceColor", which is an enumeration that can have two possible values: "White" or "Black".
- * This parameter is used to determine which player's king to check for checkmate.
- * 
- * @return The first function, `isMovePuttingKingInCheck`, returns a boolean value indicating whether a
- * move puts the king in check.
+ * The SpectatorBroadcaster class fans the moves of one game out to many subscriber file descriptors.
  */
-bool ChessBoard::isMovePuttingKingInCheck(int fromRow, int fromCol, int toRow, int toCol, PieceColor currentPlayer) const {
-    // Make a copy of the board and simulate the move
-    ChessBoard tempBoard(*this);
-    tempBoard.movePiece(fromRow, fromCol, toRow, toCol);
+class SpectatorBroadcaster {
+public:
+    // A subscriber further behind than this many bytes is disconnected
+    static constexpr std::size_t MaxBacklog = 1 << 20;
 
-    // Get the king's position
-    int kingRow = -1;
-    int kingCol = -1;
+    // Writing to a spectator that went away must fail with EPIPE rather than kill the process
+    explicit SpectatorBroadcaster(const Position& start) : current(start) {
+        std::signal(SIGPIPE, SIG_IGN);
+    }
+    SpectatorBroadcaster(const SpectatorBroadcaster&) = delete;
+    SpectatorBroadcaster& operator=(const SpectatorBroadcaster&) = delete;
+    ~SpectatorBroadcaster();
 
-    // Find the king's position
-    /* The above code is searching for the position of the current player's king on a chessboard
-    represented by the `tempBoard` object. It iterates through each cell on the board using nested
-    for loops, and checks if there is a non-null chess piece at that position. If there is a piece
-    and it is a king of the current player's color, the `kingRow` and `kingCol` variables are
-    updated with the row and column indices of the king's position. The code then breaks out of the
-    inner loop and continues with the rest of the program. */
-    for (int i = 0; i < 8; ++i) {
-        for (int j = 0; j < 8; ++j) {
-            ChessPiece* piece = tempBoard.getPiece(i, j);
-            if (piece && piece->getColor() == currentPlayer && dynamic_cast<King*>(piece)) {
-                kingRow = i;
-                kingCol = j;
-                break;
-            }
-        }
+    void addSubscriber(int fd);
+    bool listen(const std::string& socketPath);
+    void acceptSubscribers();
+    void publish(const Position& position);
+    void flush();
+
+    std::size_t subscriberCount() const {
+        return subscribers.size();
     }
 
-    /* The above code is checking if the variables `kingRow` and `kingCol` are equal to -1. If either
-    of them is -1, it means that the king was not found, and the code returns false. */
-    if (kingRow == -1 || kingCol == -1) {
-        // King not found
+    std::size_t batchSize() const {
+        return batch.size();
+    }
+
+private:
+    // batchOffset skips the frames of the pending batch that the subscriber's snapshot already covers
+    struct Subscriber {
+        int fd;
+        std::string backlog;
+        std::size_t batchOffset;
+    };
+
+    Position current;
+    std::uint32_t sequence = 0;
+    std::vector<Subscriber> subscribers;
+    std::string batch;
+    std::string snapshot;
+    std::uint32_t snapshotSequence = UINT32_MAX;
+    int listenFd = -1;
+    std::string listenPath;
+
+    const std::string& snapshotFrame();
+};
+
+template <typename T>
+void appendLittleEndian(std::string& out, T value) {
+    for (std::size_t i = 0; i < sizeof(T); ++i) {
+        out += static_cast<char>((static_cast<std::uint64_t>(value) >> (8 * i)) & 0xFF);
+    }
+}
+
+SpectatorBroadcaster::~SpectatorBroadcaster() {
+    for (const Subscriber& subscriber : subscribers) {
+        ::close(subscriber.fd);
+    }
+    if (listenFd >= 0) {
+        ::close(listenFd);
+        ::unlink(listenPath.c_str());
+    }
+}
+
+/**
+ * The function adds a subscriber and queues the current board for it. Deltas already queued for the
+ * next flush() are skipped for it, since the snapshot includes them. The broadcaster takes ownership
+ * of fd and switches it to non-blocking mode.
+ */
+void SpectatorBroadcaster::addSubscriber(int fd) {
+    ::fcntl(fd, F_SETFL, ::fcntl(fd, F_GETFL) | O_NONBLOCK);
+#if defined(SO_NOSIGPIPE)
+    int on = 1;
+    ::setsockopt(fd, SOL_SOCKET, SO_NOSIGPIPE, &on, sizeof(on));
+#endif
+    subscribers.push_back({fd, snapshotFrame(), batch.size()});
+}
+
+/**
+ * The function starts listening for spectators on a Unix socket at socketPath.
+ *
+ * @return true if the socket could be created.
+ */
+bool SpectatorBroadcaster::listen(const std::string& socketPath) {
+    sockaddr_un address{};
+    if (socketPath.size() >= sizeof(address.sun_path)) {
+        return false;
+    }
+    listenFd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    if (listenFd < 0) {
+        return false;
+    }
+    address.sun_family = AF_UNIX;
+    std::memcpy(address.sun_path, socketPath.c_str(), socketPath.size() + 1);
+    ::unlink(socketPath.c_str());
+    if (::bind(listenFd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0 || ::listen(listenFd, 128) != 0) {
+        ::close(listenFd);
+        listenFd = -1;
         return false;
     }
+    ::fcntl(listenFd, F_SETFL, ::fcntl(listenFd, F_GETFL) | O_NONBLOCK);
+    listenPath = socketPath;
+    return true;
+}
 
-    // Check if the king is in check on the temporary board
-    return tempBoard.isSquareUnderThreat(kingRow, kingCol, currentPlayer);
+/**
+ * The function adds every spectator waiting on the listening socket without blocking.
+ */
+void SpectatorBroadcaster::acceptSubscribers() {
+    if (listenFd < 0) {
+        return;
+    }
+    int fd;
+    while ((fd = ::accept(listenFd, nullptr, nullptr)) >= 0) {
+        addSubscriber(fd);
+    }
 }
 
+// The snapshot frame of the current position, rendered at most once per position
+const std::string& SpectatorBroadcaster::snapshotFrame() {
+    if (snapshotSequence != sequence) {
+        std::string payload;
+        appendLittleEndian(payload, sequence);
+        appendLittleEndian(payload, current.key);
+        for (int square = 0; square < SQUARE_NB; ++square) {
+            payload += static_cast<char>(pieceCode(current, square));
+        }
+        renderBoard(current, payload);
+
+        snapshot.clear();
+        appendLittleEndian(snapshot, static_cast<std::uint16_t>(payload.size()));
+        snapshot += static_cast<char>(FrameType::SNAPSHOT);
+        snapshot += payload;
+        snapshotSequence = sequence;
+    }
+    return snapshot;
+}
 
 /**
- * The function `isCheckmate` checks if the current player's king is in checkmate by iterating through
- * the board, finding the king's position, checking if the king is in check, and then checking if there
- * are any legal moves to get the king out of check.
- * 
- * @param currentPlayer The parameter "currentPlayer" represents the color of the player whose turn it
- * is to move. It can be either "PieceColor::WHITE" or "PieceColor::BLACK", indicating whether it is
- * the white player or the black player's turn.
- * 
- * @return a boolean value. It returns true if the current player's king is in checkmate, and false
- * otherwise.
+ * The function queues a delta frame from the last published position to position. Frames are sent
+ * by the next flush().
  */
-bool ChessBoard::isCheckmate(PieceColor currentPlayer) {
-    // Iterate through the board to find the current player's king
-  int kingRow = -1;
-    int kingCol = -1;
+void SpectatorBroadcaster::publish(const Position& position) {
+    Bitboard changed = (current.byColor[0] ^ position.byColor[0]) | (current.byColor[1] ^ position.byColor[1]);
+    for (int type = 0; type < PIECE_TYPE_NB; ++type) {
+        changed |= current.byType[type] ^ position.byType[type];
+    }
+    current = position;
+    ++sequence;
 
-    // Find the king's position
-   /* The above code is searching for the position of the current player's king on a chessboard. It
-   iterates through each cell on the chessboard and checks if there is a piece at that position. If
-   there is a piece and it is the current player's king, the code stores the row and column of the
-   king's position in the variables kingRow and kingCol. */
-    for (int i = 0; i < 8; ++i) {
-        for (int j = 0; j < 8; ++j) {
-            ChessPiece* piece = getPiece(i, j);
-            if (piece && piece->getColor() == currentPlayer && dynamic_cast<King*>(piece)) {
-                kingRow = i;
-                kingCol = j;
-                break;
+    const std::size_t count = static_cast<std::size_t>(popCount(changed));
+    appendLittleEndian(batch, static_cast<std::uint16_t>(4 + 8 + 1 + 2 * count));
+    batch += static_cast<char>(FrameType::DELTA);
+    appendLittleEndian(batch, sequence);
+    appendLittleEndian(batch, position.key);
+    batch += static_cast<char>(count);
+    while (changed) {
+        int square = popLsb(changed);
+        batch += static_cast<char>(square);
+        batch += static_cast<char>(pieceCode(position, square));
+    }
+}
+
+/**
+ * The function writes the queued frames to every subscriber, each with a single non-blocking writev
+ * of its backlog followed by the batch. Data a subscriber cannot take yet is kept in its backlog;
+ * subscribers that closed their end or fall too far behind are dropped.
+ */
+void SpectatorBroadcaster::flush() {
+    std::size_t kept = 0;
+    for (std::size_t i = 0; i < subscribers.size(); ++i) {
+        Subscriber& subscriber = subscribers[i];
+        const std::size_t offset = subscriber.batchOffset;
+        subscriber.batchOffset = 0;
+        iovec parts[2] = {{const_cast<char*>(subscriber.backlog.data()), subscriber.backlog.size()},
+                          {const_cast<char*>(batch.data()) + offset, batch.size() - offset}};
+        const std::size_t total = subscriber.backlog.size() + batch.size() - offset;
+        ssize_t written = total ? ::writev(subscriber.fd, parts, 2) : 0;
+        bool alive = true;
+        if (written < 0) {
+            alive = errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR;
+            written = 0;
+        }
+        if (alive && static_cast<std::size_t>(written) < total) {
+            // Keep what was not written, in order
+            std::size_t fromBacklog = std::min(static_cast<std::size_t>(written), subscriber.backlog.size());
+            subscriber.backlog.erase(0, fromBacklog);
+            subscriber.backlog.append(batch, offset + static_cast<std::size_t>(written) - fromBacklog, std::string::npos);
+            alive = subscriber.backlog.size() <= MaxBacklog;
+        } else {
+            subscriber.backlog.clear();
+        }
+        if (alive) {
+            // Moving a subscriber onto itself would empty its backlog
+            if (kept != i) {
+                subscribers[kept] = std::move(subscriber);
             }
+            ++kept;
+        } else {
+            ::close(subscriber.fd);
         }
     }
+    subscribers.resize(kept);
+    batch.clear();
+}
 
-    /* The above code is checking if the variables `kingRow` and `kingCol` are equal to -1. If either
-    of them is -1, it means that the king was not found, and the code returns false. */
-    if (kingRow == -1 || kingCol == -1) {
-        // King not found
-        return false;
+/**
+ * The function benchmarks broadcasting random games to local spectators connected through Unix
+ * socket pairs, drained by a reader thread. It prints the fan-out latency per move, the CPU time
+ * per subscriber and update, the size of a delta compared to a full redraw, and the snapshot cost.
+ * One extra spectator with small socket buffers only starts reading after the last move, so its
+ * frames queue up in the backlog; it checks that every frame arrives whole and in sequence.
+ *
+ * @return true if the sockets could be created and the slow spectator received every frame intact.
+ */
+bool benchmarkBroadcast(int subscriberCount, int moveCount) {
+    using Clock = std::chrono::steady_clock;
+    ChessBoard startBoard;
+    SpectatorBroadcaster broadcaster(startBoard.getPosition());
+    std::vector<int> readers;
+    for (int i = 0; i < subscriberCount; ++i) {
+        int pair[2];
+        if (::socketpair(AF_UNIX, SOCK_STREAM, 0, pair) != 0) {
+            std::cerr << "Cannot create socket pair " << i << std::endl;
+            for (int fd : readers) {
+                ::close(fd);
+            }
+            return false;
+        }
+        broadcaster.addSubscriber(pair[0]);
+        readers.push_back(pair[1]);
     }
-
-    // Check if the king is in check
-    /* The above code is checking if the king is under threat (in check) by calling the function
-    `isSquareUnderThreat` with the parameters `kingRow`, `kingCol`, and `currentPlayer`. If the king
-    is not under threat, the code returns `false`, indicating that the king is not in checkmate. */
-    if (!isSquareUnderThreat(kingRow, kingCol, currentPlayer)) {
-        return false; // King is not in check, so not in checkmate
+    int slowPair[2];
+    if (::socketpair(AF_UNIX, SOCK_STREAM, 0, slowPair) != 0) {
+        std::cerr << "Cannot create the slow socket pair" << std::endl;
+        for (int fd : readers) {
+            ::close(fd);
+        }
+        return false;
     }
+    const int smallBuffer = 4096;
+    ::setsockopt(slowPair[0], SOL_SOCKET, SO_SNDBUF, &smallBuffer, sizeof(smallBuffer));
+    ::setsockopt(slowPair[1], SOL_SOCKET, SO_RCVBUF, &smallBuffer, sizeof(smallBuffer));
+    ::fcntl(slowPair[1], F_SETFL, ::fcntl(slowPair[1], F_GETFL) | O_NONBLOCK);
+    broadcaster.addSubscriber(slowPair[0]);
+    broadcaster.flush();
 
-    // Check if there are any legal moves to get the king out of check
-    /* The above code is a nested loop that iterates through each square on a chessboard (8x8). It
-    checks if there is a chess piece on the current square and if the piece belongs to the current
-    player. If both conditions are met, it then checks all possible moves for that piece. */
-    for (int i = 0; i < 8; ++i) {
-        for (int j = 0; j < 8; ++j) {
-            ChessPiece* piece = getPiece(i, j);
-            if (piece && piece->getColor() == currentPlayer) {
-                for (int toRow = 0; toRow < 8; ++toRow) {
-                    for (int toCol = 0; toCol < 8; ++toCol) {
-                        if (piece->isValidMove(i, j, toRow, toCol) &&
-                            movePiece(i, j, toRow, toCol) &&
-                            !isSquareUnderThreat(kingRow, kingCol, currentPlayer)) {
-                            // The move is legal and gets the king out of check
-                            // Undo the move
-                            movePiece(toRow, toCol, i, j);
-                            movePiece(i, j, toRow, toCol);
-                            return false;
-                        }
+    // Drain every reader so the writes never back up
+    std::atomic<bool> done(false);
+    std::atomic<std::uint64_t> received(0);
+    std::thread drain([&]() {
+        std::vector<pollfd> fds;
+        for (int fd : readers) {
+            fds.push_back({fd, POLLIN, 0});
+        }
+        char buffer[65536];
+        while (!done.load()) {
+            if (::poll(fds.data(), fds.size(), 10) <= 0) {
+                continue;
+            }
+            for (pollfd& entry : fds) {
+                if (entry.revents & POLLIN) {
+                    ssize_t n = ::read(entry.fd, buffer, sizeof(buffer));
+                    if (n > 0) {
+                        received += static_cast<std::uint64_t>(n);
                     }
                 }
             }
         }
+    });
+
+    // The slow spectator waits for the moves to end, then reads and parses the frames it gets
+    std::atomic<bool> slowStart(false);
+    std::atomic<bool> slowDone(false);
+    std::atomic<bool> slowIntact(true);
+    std::atomic<std::uint32_t> slowSequence(0);
+    std::atomic<std::uint64_t> slowReceived(0);
+    std::thread slowReader([&]() {
+        std::string stream;
+        char buffer[256];
+        bool first = true;
+        while (!slowStart.load()) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        while (!slowDone.load()) {
+            ssize_t n = ::read(slowPair[1], buffer, sizeof(buffer));
+            if (n <= 0) {
+                std::this_thread::sleep_for(std::chrono::microseconds(100));
+                continue;
+            }
+            stream.append(buffer, static_cast<std::size_t>(n));
+            slowReceived += static_cast<std::uint64_t>(n);
+            // Each frame is a 16-bit length, the frame type and a payload starting with the sequence
+            std::size_t pos = 0;
+            while (stream.size() - pos >= 7) {
+                auto byte = [&](std::size_t offset) { return static_cast<std::uint8_t>(stream[pos + offset]); };
+                const std::size_t length = byte(0) | byte(1) << 8;
+                if (stream.size() - pos < 3 + length) {
+                    break;
+                }
+                const std::uint32_t frameSequence = byte(3) | byte(4) << 8 | byte(5) << 16 |
+                                                    static_cast<std::uint32_t>(byte(6)) << 24;
+                const auto type = static_cast<FrameType>(byte(2));
+                if ((type != FrameType::DELTA && type != FrameType::SNAPSHOT) ||
+                    (!first && frameSequence != slowSequence.load() + 1)) {
+                    slowIntact = false;
+                }
+                first = false;
+                slowSequence = frameSequence;
+                pos += 3 + length;
+            }
+            stream.erase(0, pos);
+        }
+    });
+
+    std::mt19937 random(1);
+    std::vector<double> latencies;
+    std::uint64_t deltaBytes = 0;
+    std::clock_t cpuStart = std::clock();
+    auto wallStart = Clock::now();
+    std::unique_ptr<ChessBoard> chessBoard = std::make_unique<ChessBoard>();
+    PieceColor currentPlayer = PieceColor::RED;
+    for (int m = 0; m < moveCount; ++m) {
+        std::vector<Move> candidates = chessBoard->generateMoves(currentPlayer);
+        std::vector<bool> legal = chessBoard->areMovesLegal(candidates, currentPlayer);
+        std::vector<Move> moves;
+        for (std::size_t i = 0; i < candidates.size(); ++i) {
+            if (legal[i]) {
+                moves.push_back(candidates[i]);
+            }
+        }
+        if (moves.empty() || chessBoard->isGameOver()) {
+            chessBoard = std::make_unique<ChessBoard>();
+            currentPlayer = PieceColor::RED;
+            continue;
+        }
+        Move move = moves[random() % moves.size()];
+        chessBoard->movePiece(move);
+        currentPlayer = opponentOf(currentPlayer);
+
+        auto start = Clock::now();
+        broadcaster.publish(chessBoard->getPosition());
+        deltaBytes += broadcaster.batchSize();
+        broadcaster.flush();
+        latencies.push_back(std::chrono::duration<double, std::micro>(Clock::now() - start).count());
+    }
+    double cpuSeconds = static_cast<double>(std::clock() - cpuStart) / CLOCKS_PER_SEC;
+    double wallSeconds = std::chrono::duration<double>(Clock::now() - wallStart).count();
+
+    // Keep flushing the backlog until the slow spectator has seen the last update or stops advancing
+    const std::uint32_t published = static_cast<std::uint32_t>(latencies.size());
+    const bool slowDropped = broadcaster.subscriberCount() <= static_cast<std::size_t>(subscriberCount);
+    Clock::time_point lastProgress = Clock::now();
+    std::uint32_t lastSequence = 0;
+    slowStart = true;
+    while (!slowDropped && slowIntact.load() && slowSequence.load() != published &&
+           Clock::now() - lastProgress < std::chrono::seconds(2)) {
+        broadcaster.flush();
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        if (slowSequence.load() != lastSequence) {
+            lastSequence = slowSequence.load();
+            lastProgress = Clock::now();
+        }
     }
+    const bool slowCaughtUp = slowIntact.load() && (slowDropped || slowSequence.load() == published);
+    slowDone = true;
+    slowReader.join();
+    ::close(slowPair[1]);
 
-    // No legal moves to get the king out of check, so it's checkmate
-    return true;
+    // Late joiners share one rendered snapshot
+    auto snapshotStart = Clock::now();
+    int pair[2];
+    if (::socketpair(AF_UNIX, SOCK_STREAM, 0, pair) == 0) {
+        broadcaster.addSubscriber(pair[0]);
+        ::close(pair[1]);
+    }
+    double snapshotMicros = std::chrono::duration<double, std::micro>(Clock::now() - snapshotStart).count();
+    std::string redraw;
+    renderBoard(chessBoard->getPosition(), redraw);
+
+    done = true;
+    drain.join();
+    for (int fd : readers) {
+        ::close(fd);
+    }
+
+    const char* slowStatus = "frames intact";
+    if (!slowIntact.load()) {
+        slowStatus = "frames corrupted";
+    } else if (slowDropped) {
+        slowStatus = "dropped for falling behind";
+    } else if (!slowCaughtUp) {
+        slowStatus = "stream stopped short";
+    }
+
+    std::sort(latencies.begin(), latencies.end());
+    double mean = 0.0;
+    for (double latency : latencies) {
+        mean += latency;
+    }
+    const std::size_t updates = std::max<std::size_t>(latencies.size(), 1);
+    mean /= updates;
+    std::cout << std::fixed << std::setprecision(3)
+              << "Subscribers: " << subscriberCount << ", updates: " << latencies.size() << "\n";
+    if (!latencies.empty()) {
+        std::cout << "Fan-out latency: mean " << mean << " us, p50 " << latencies[latencies.size() / 2]
+                  << " us, p99 " << latencies[latencies.size() * 99 / 100] << " us\n";
+    }
+    std::cout << "CPU per subscriber per update: " << cpuSeconds * 1e6 / updates / std::max(subscriberCount, 1)
+              << " us (process CPU " << cpuSeconds * 1e3 << " ms, wall " << wallSeconds * 1e3 << " ms, "
+              << "includes move generation and the reader thread)\n"
+              << "Bytes per update: " << static_cast<double>(deltaBytes) / updates << " (full redraw "
+              << redraw.size() << "), received " << received.load() << " bytes in total\n"
+              << "Late joiner snapshot: " << snapshotMicros << " us\n"
+              << "Slow spectator: " << slowReceived.load() << " bytes, reached update " << slowSequence.load()
+              << " of " << published << ", "
+              << slowStatus << std::endl;
+    return slowCaughtUp;
+}
+#endif
+
+/* The code below cross-checks the fast bitboard paths against the reference rules implemented by
+the piece classes. At each position it compares the legal move set, make and unmake of every legal
+move, the position hash, the king location and the checkmate status. A failing position is shrunk
+by removing pieces while the failure persists, and reported as a FEN string. */
+
+// The pieces on the board array of chessBoard, without castling rights or en-passant square
+Position boardPieces(const ChessBoard& chessBoard) {
+    Position pieces;
+    for (int square = 0; square < SQUARE_NB; ++square) {
+        ChessPiece* piece = chessBoard.getPiece(rowOf(square), colOf(square));
+        if (piece) {
+            pieces.put(square, piece->getColor(), pieceTypeOf(piece->getSymbol()));
+        }
+    }
+    return pieces;
 }
 
 /**
- * The above code implements the isValidMove and getSymbol functions for different chess pieces.
- * 
- * @param rowFrom The row index of the current position of the piece.
- * @param colFrom The parameter "colFrom" represents the column index of the starting position of the
- * piece.
- * @param rowTo The parameter "rowTo" represents the row index of the destination position where the
- * piece is being moved to.
- * @param colTo The parameter "colTo" represents the column index of the destination position where the
- * piece is being moved to.
- * 
- * @return In each of the member functions, a boolean value is being returned. This value represents
- * whether the move from the starting position (rowFrom, colFrom) to the destination position (rowTo,
- * colTo) is a valid move for the specific chess piece.
+ * The function compares the fast and the reference answers for currentPlayer on chessBoard.
+ *
+ * @param move Set to the move the two paths disagree on, or to no move if the failure is not about
+ * a single move.
+ *
+ * @return a description of the first disagreement found, or an empty string if there is none.
  */
-// Implementation of member functions for Pawn
-bool Pawn::isValidMove(int rowFrom, int colFrom, int rowTo, int colTo) const {
-     
-//Pawn movement logic
-    /* The above code is calculating the difference between two rows and the absolute difference
-    between two columns. */
-    int rowDiff = rowTo - rowFrom;
-    int colDiff = std::abs(colTo - colFrom);
+std::string findDiscrepancy(ChessBoard& chessBoard, PieceColor currentPlayer, Move& move) {
+    move = Move();
+    const Position& position = chessBoard.getPosition();
+
+    // Reference: every move movePiece accepts that does not put the king in check, where a pawn
+    // reaching the last row counts once for each promotion piece
+    std::vector<bool> reference(SQUARE_NB * SQUARE_NB, false);
+    std::size_t referenceCount = 0;
+    int referenceKing = -1;
+    for (int from = 0; from < SQUARE_NB; ++from) {
+        ChessPiece* piece = chessBoard.getPiece(rowOf(from), colOf(from));
+        if (!piece) {
+            continue;
+        }
+        if (piece->getSymbol() == 'K' && piece->getColor() == currentPlayer) {
+            referenceKing = from;
+        }
+        if (piece->getColor() != currentPlayer) {
+            continue;
+        }
+        for (int to = 0; to < SQUARE_NB; ++to) {
+            ChessPiece* target = chessBoard.getPiece(rowOf(to), colOf(to));
+            reference[from * SQUARE_NB + to] =
+                piece->isValidMove(rowOf(from), colOf(from), rowOf(to), colOf(to)) &&
+                (!target || target->getColor() != currentPlayer) &&
+                !chessBoard.isMovePuttingKingInCheck(rowOf(from), colOf(from), rowOf(to), colOf(to), currentPlayer);
+            if (reference[from * SQUARE_NB + to]) {
+                referenceCount += (piece->getSymbol() == 'P' && (rowOf(to) == 0 || rowOf(to) == 7)) ? 4 : 1;
+            }
+        }
+    }
 
-    /* The above code is implementing the movement rules for a pawn in a game. It checks the color of
-    the pawn and then determines if the move is valid based on the difference in rows and columns.
-    If the pawn is red, it can move one step forward, two steps forward from the starting position,
-    or capture diagonally. If the pawn is blue, it can move one step downward, two steps downward
-    from the starting position, or capture diagonally. */
-    if (getColor() == PieceColor::RED) {
-        // Red pawn moves upward
-        if (rowDiff == 1 && colDiff == 0) {
-            return true; // Valid one-step forward move
-        } else if (rowFrom == 1 && rowDiff == 2 && colDiff == 0) {
-            return true; // Valid two-step forward move from the starting position
-        } else if (rowDiff == 1 && colDiff == 1) {
-            return true; // Valid diagonal capture
+    // Fast: the generator filtered by the batch legality check, and the legal move generator
+    std::vector<bool> fast(SQUARE_NB * SQUARE_NB, false);
+    std::vector<Move> candidates = chessBoard.generateMoves(currentPlayer);
+    std::vector<bool> legal = chessBoard.areMovesLegal(candidates, currentPlayer);
+    for (std::size_t i = 0; i < candidates.size(); ++i) {
+        if (legal[i]) {
+            fast[candidates[i].from() * SQUARE_NB + candidates[i].to()] = true;
         }
+    }
+    MoveList legalMoves;
+    if (currentPlayer == PieceColor::RED) {
+        generateLegalMoves<PieceColor::RED>(position, legalMoves);
     } else {
-        // Blue pawn moves downward
-        if (rowDiff == -1 && colDiff == 0) {
-            return true; // Valid one-step forward move
-        } else if (rowFrom == 6 && rowDiff == -2 && colDiff == 0) {
-            return true; // Valid two-step forward move from the starting position
-        } else if (rowDiff == -1 && colDiff == 1) {
-            return true; // Valid diagonal capture
+        generateLegalMoves<PieceColor::BLUE>(position, legalMoves);
+    }
+
+    for (int i = 0; i < SQUARE_NB * SQUARE_NB; ++i) {
+        if (reference[i] != fast[i]) {
+            move = moveFor(position, i / SQUARE_NB, i % SQUARE_NB);
+            return reference[i] ? "legal move rejected by the fast path" : "illegal move accepted by the fast path";
+        }
+    }
+    if (legalMoves.size() != referenceCount) {
+        return "generateLegalMoves returned " + std::to_string(legalMoves.size()) + " moves, reference " +
+               std::to_string(referenceCount);
+    }
+    for (const Move legalMove : legalMoves) {
+        if (!reference[legalMove.from() * SQUARE_NB + legalMove.to()]) {
+            move = legalMove;
+            return "illegal move returned by generateLegalMoves";
         }
     }
 
-    return false;
+    // Make and unmake: the pieces after makeMove match movePiece, and unmakeMove restores everything
+    for (const Move legalMove : legalMoves) {
+        move = legalMove;
+        Position played = position;
+        UndoInfo undo;
+        played.makeMove(legalMove, undo);
+        ChessBoard after(chessBoard);
+        after.movePiece(legalMove);
+        const Position moved = boardPieces(after);
+        if (moved.byColor != played.byColor || moved.byType != played.byType || moved.pawnKey != played.pawnKey) {
+            return "makeMove and movePiece leave different pieces";
+        }
+        played.unmakeMove(legalMove, undo);
+        if (played.byColor != position.byColor || played.byType != position.byType || played.typeOn != position.typeOn ||
+            played.key != position.key || played.pawnKey != position.pawnKey ||
+            played.castlingRights != position.castlingRights || played.epSquare != position.epSquare) {
+            return "unmakeMove does not restore the position";
+        }
+    }
+    move = Move();
+
+    // Threats against the pieces of currentPlayer, hash and king location
+    const Bitboard attacked = chessBoard.attackedSquares(opponentOf(currentPlayer));
+    Bitboard ours = position.pieces(currentPlayer);
+    while (ours) {
+        const int square = popLsb(ours);
+        if (chessBoard.isSquareUnderThreat(rowOf(square), colOf(square), currentPlayer) !=
+            static_cast<bool>(attacked & squareBB(square))) {
+            return "attackedSquares disagrees with isSquareUnderThreat on square " + std::to_string(square);
+        }
+    }
+    Position rebuilt = boardPieces(chessBoard);
+    rebuilt.setCastlingRights(chessBoard.getCastlingRights());
+    rebuilt.setEnPassant(chessBoard.getEnPassantSquare());
+    if (rebuilt.key != position.key || rebuilt.pawnKey != position.pawnKey) {
+        return "incremental hash differs from the hash of the board";
+    }
+    if (referenceKing != position.kingSquare(currentPlayer)) {
+        return "king square differs from the board";
+    }
+
+    // Checkmate status
+    const bool fastMate = (currentPlayer == PieceColor::RED ? isInCheck<PieceColor::RED>(position)
+                                                            : isInCheck<PieceColor::BLUE>(position)) &&
+                          legalMoves.empty();
+    if (chessBoard.isCheckmate(currentPlayer) != fastMate) {
+        return fastMate ? "checkmate missed by isCheckmate" : "false checkmate reported by isCheckmate";
+    }
+    return std::string();
 }
 
 /**
- * The function returns the symbol 'P' for a Pawn object.
- * 
- * @return The character 'P' is being returned.
+ * The function shrinks a failing position by removing pieces one at a time for as long as the
+ * position keeps failing, and returns the smallest failing position found.
  */
-char Pawn::getSymbol() const {
-    return 'P';
+Position shrinkFailure(Position position, PieceColor currentPlayer, std::string& what, Move& move) {
+    bool shrunk = true;
+    while (shrunk) {
+        shrunk = false;
+        for (int square = 0; square < SQUARE_NB; ++square) {
+            if (position.isEmpty(square)) {
+                continue;
+            }
+            Position smaller = position;
+            smaller.remove(square);
+            ChessBoard chessBoard(smaller);
+            chessBoard.setQuiet(true);
+            Move smallerMove;
+            std::string smallerWhat = findDiscrepancy(chessBoard, currentPlayer, smallerMove);
+            if (!smallerWhat.empty()) {
+                position = smaller;
+                what = smallerWhat;
+                move = smallerMove;
+                shrunk = true;
+            }
+        }
+    }
+    return position;
 }
 
-/**
- * The isValidMove function checks if a move for a Rook piece is valid by ensuring that the move is
- * either horizontal or vertical and that the path between the starting and ending positions is clear.
- * 
- * @param rowFrom The starting row of the Rook's position on the chessboard.
- * @param colFrom The column index of the starting position of the Rook.
- * @param rowTo The row index of the destination position where the Rook is being moved to.
- * @param colTo The parameter "colTo" represents the column index of the destination position where the
- * Rook is being moved to.
- * 
- * @return a boolean value.
- */
-// Implementation of member functions for Rook
-bool Rook::isValidMove(int rowFrom, int colFrom, int rowTo, int colTo) const {
-    // Rook movement logic
-      int rowDiff = rowTo - rowFrom;
-      int colDiff = colTo - colFrom;
+// A plain from/to pair of a special move and whether ChessBoard::areMovesLegal must accept it
+struct MovePairCase {
+    const char* fen;
+    const char* move;
+    bool legal;
+};
 
-    // Rook can move horizontally or vertically
-    return (rowDiff == 0 || colDiff == 0) && isPathClear(rowFrom, colFrom, rowTo, colTo);
+constexpr MovePairCase MovePairCases[] = {
+    {"r3k2r/8/8/8/8/8/8/R3K2R w KQkq - 0 1", "e1g1", true},
+    {"r3k2r/8/8/8/8/8/8/R3K2R w KQkq - 0 1", "e1c1", true},
+    {"r3k2r/8/8/8/8/8/8/R3K2R b KQkq - 0 1", "e8g8", true},
+    {"r3k2r/8/8/8/8/8/8/R3K2R b KQkq - 0 1", "e8c8", true},
+    {"r3k2r/8/8/8/8/8/8/R3K2R w Qkq - 0 1", "e1g1", false},  // No castling right
+    {"r3k2r/8/8/8/8/8/5r2/R3K2R w KQkq - 0 1", "e1g1", false}, // Passes an attacked square
+    {"r3k2r/8/8/8/8/8/5r2/R3K2R w KQkq - 0 1", "e1c1", true},
+    {"4k3/8/8/3pP3/8/8/8/4K3 w - d6 0 1", "e5d6", true},
+    {"4k3/8/8/8/3Pp3/8/8/4K3 b - d3 0 1", "e4d3", true},
+    {"8/8/8/K2pP2r/8/8/8/4k3 w - d6 0 1", "e5d6", false},      // Both pawns leave the pinned row
+    {"1n2k3/P7/8/8/8/8/8/4K3 w - - 0 1", "a7a8", true},
+    {"1n2k3/P7/8/8/8/8/8/4K3 w - - 0 1", "a7b8", true},
+    {"4k3/8/8/8/8/8/p7/4K3 b - - 0 1", "a2a1", true},
+};
 
+/* The function checks ChessBoard::areMovesLegal on MovePairCases, passing each move as a plain pair
+of squares, and reports every case it gets wrong. It returns the number of such cases. */
+int checkMovePairCases(std::ostream& report) {
+    int failed = 0;
+    for (const MovePairCase& test : MovePairCases) {
+        Position position;
+        PieceColor sideToMove;
+        int from;
+        int to;
+        PieceType promotion;
+        if (!parseFen(test.fen, position, sideToMove) || !parseMoveText(test.move, from, to, promotion)) {
+            report << "FAIL: invalid move pair case " << test.fen << ' ' << test.move << std::endl;
+            ++failed;
+            continue;
+        }
+        ChessBoard chessBoard(position);
+        if (chessBoard.areMovesLegal({Move(from, to)}, sideToMove)[0] != test.legal) {
+            report << "FAIL: areMovesLegal " << (test.legal ? "rejects " : "accepts ") << test.move
+                   << "\n  position: " << test.fen << std::endl;
+            ++failed;
+        }
+    }
+    return failed;
 }
 
-/**
- * The function returns the symbol 'R' for a Rook piece.
- * 
- * @return The character 'R' is being returned.
- */
-char Rook::getSymbol() const {
-    return 'R';
-}
+// Options of the validation mode
+struct ValidationOptions {
+    unsigned threads = 0;
+    double seconds = 60.0;
+    std::string archivePath;
+    std::string fen;
+};
 
 /**
- * The isValidMove function checks if the move from (rowFrom, colFrom) to (rowTo, colTo) is a valid
- * move for a Knight in chess.
- * 
- * @param rowFrom The row index of the starting position of the Knight's move.
- * @param colFrom The column index of the starting position of the Knight.
- * @param rowTo The row index of the destination position where the Knight is being moved to.
- * @param colTo The parameter "colTo" represents the column index of the destination position where the
- * Knight is being moved to.
- * 
- * @return a boolean value.
+ * The function runs the differential validation. Every thread first replays its share of the
+ * archive games, if any, and then plays random games until the time is up. Progress with position
+ * throughput is reported every ten seconds, and each failure with its shrunk FEN and move.
+ *
+ * @return true if no discrepancy was found.
  */
-// Implementation of member functions for Knight
-bool Knight::isValidMove(int rowFrom, int colFrom, int rowTo, int colTo) const {
-   // Knight movement logic
-    int rowDiff = std::abs(rowTo - rowFrom);
-    int colDiff = std::abs(colTo - colFrom);
+bool runValidation(ValidationOptions options) {
+    // The boards of the reference path are quiet, so the report is the only output
+    std::ostream& report = std::cout;
+    std::mutex reportMutex;
 
-     return (rowDiff == 2 && colDiff == 1) || (rowDiff == 1 && colDiff == 2);
-    
-    
-}
+    auto describeMove = [](Move move) {
+        return move ? " move " + moveText(move) : std::string();
+    };
 
-/**
- * The function returns the symbol 'N' for a Knight.
- * 
- * @return The character 'N' is being returned.
- */
-char Knight::getSymbol() const {
-    return 'N';
-}
+    if (!options.fen.empty()) {
+        Position position;
+        PieceColor sideToMove;
+        bool valid = parseFen(options.fen, position, sideToMove);
+        std::string what;
+        Move move;
+        if (valid) {
+            ChessBoard chessBoard(position);
+            chessBoard.setQuiet(true);
+            what = findDiscrepancy(chessBoard, sideToMove, move);
+        }
+        if (!valid) {
+            std::cerr << "Invalid FEN: " << options.fen << std::endl;
+            return false;
+        }
+        std::cout << (what.empty() ? "OK" : "FAIL: " + what + describeMove(move)) << std::endl;
+        return what.empty();
+    }
 
-/**
- * The isValidMove function checks if the move for a Bishop or Queen is valid based on the movement
- * logic and if the path is clear.
- * 
- * @param rowFrom The row index of the starting position of the piece.
- * @param colFrom The column index of the starting position of the piece.
- * @param rowTo The row index of the destination position where the piece is being moved to.
- * @param colTo The parameter "colTo" represents the column index of the destination position on the
- * chessboard.
- * 
- * @return In the `isValidMove` function for both the Bishop and Queen classes, a boolean value is
- * being returned. This boolean value represents whether the move from the starting position (rowFrom,
- * colFrom) to the ending position (rowTo, colTo) is a valid move for the respective chess piece.
- */
-// Implementation of member functions for Bishop
-bool Bishop::isValidMove(int rowFrom, int colFrom, int rowTo, int colTo) const {
-    // Bishop movement logic
-    int rowDiff = rowTo - rowFrom;
-    int colDiff = colTo - colFrom;
+    GameArchive archive;
+    if (!options.archivePath.empty() && !archive.open(options.archivePath)) {
+        std::cerr << "Cannot read archive " << options.archivePath << std::endl;
+        return false;
+    }
+    if (options.threads == 0) {
+        options.threads = std::max(1u, std::thread::hardware_concurrency());
+    }
 
-    return std::abs(rowDiff) == std::abs(colDiff) && isPathClear(rowFrom, colFrom, rowTo, colTo);
-    
-    
-}
+    using Clock = std::chrono::steady_clock;
+    const Clock::time_point start = Clock::now();
+    const Clock::time_point deadline = start + std::chrono::duration_cast<Clock::duration>(
+                                                   std::chrono::duration<double>(options.seconds));
+    std::atomic<std::uint64_t> positions(0);
+    std::atomic<std::uint64_t> games(0);
+    std::atomic<std::uint64_t> failures(0);
+    failures += checkMovePairCases(report);
 
-/**
- * The function returns the symbol 'B' for a Bishop piece.
- * 
- * @return The character 'B' is being returned.
- */
-char Bishop::getSymbol() const {
-    return 'B';
-}
+    auto checkAndReport = [&](ChessBoard& chessBoard, PieceColor currentPlayer) {
+        Move move;
+        std::string what = findDiscrepancy(chessBoard, currentPlayer, move);
+        ++positions;
+        if (what.empty()) {
+            return true;
+        }
+        Position shrunk = shrinkFailure(chessBoard.getPosition(), currentPlayer, what, move);
+        std::lock_guard<std::mutex> lock(reportMutex);
+        if (++failures <= 20) {
+            report << "FAIL: " << what << describeMove(move) << "\n  position: "
+                   << toFen(chessBoard.getPosition(), currentPlayer) << "\n  shrunk:   " << toFen(shrunk, currentPlayer)
+                   << std::endl;
+        }
+        return false;
+    };
 
-// Implementation of member functions for Queen
-bool Queen::isValidMove(int rowFrom, int colFrom, int rowTo, int colTo) const {
-     //Queen movement logic (combination of rook and bishop)
-    int rowDiff = rowTo - rowFrom;
-    int colDiff = colTo - colFrom;
+    std::vector<std::thread> workers;
+    for (unsigned t = 0; t < options.threads; ++t) {
+        workers.emplace_back([&, t]() {
+            // Corpus games first
+            for (std::uint64_t g = t; g < archive.gameCount() && Clock::now() < deadline; g += options.threads) {
+                ArchivedGame game = archive.game(g);
+                ChessBoard chessBoard;
+                chessBoard.setQuiet(true);
+                PieceColor currentPlayer = PieceColor::RED;
+                for (std::uint32_t ply = 0; ply <= game.moveCount; ++ply) {
+                    if (!checkAndReport(chessBoard, currentPlayer) || ply == game.moveCount) {
+                        break;
+                    }
+                    if (!chessBoard.movePiece(decodeMove(chessBoard.getPosition(), game.moves[ply]))) {
+                        break;
+                    }
+                    currentPlayer = opponentOf(currentPlayer);
+                }
+                ++games;
+            }
+            // Then random games
+            std::mt19937 random(0x5EED0000u + t);
+            MoveList legalMoves;
+            while (Clock::now() < deadline) {
+                ChessBoard chessBoard;
+                chessBoard.setQuiet(true);
+                PieceColor currentPlayer = PieceColor::RED;
+                for (int ply = 0; ply < 300 && !chessBoard.isGameOver(); ++ply) {
+                    if (!checkAndReport(chessBoard, currentPlayer)) {
+                        break;
+                    }
+                    legalMoves.clear();
+                    if (currentPlayer == PieceColor::RED) {
+                        generateLegalMoves<PieceColor::RED>(chessBoard.getPosition(), legalMoves);
+                    } else {
+                        generateLegalMoves<PieceColor::BLUE>(chessBoard.getPosition(), legalMoves);
+                    }
+                    if (legalMoves.empty()) {
+                        break;
+                    }
+                    Move move = legalMoves[random() % legalMoves.size()];
+                    chessBoard.movePiece(move);
+                    currentPlayer = opponentOf(currentPlayer);
+                }
+                ++games;
+            }
+        });
+    }
 
-    return (rowDiff == 0 || colDiff == 0 || std::abs(rowDiff) == std::abs(colDiff)) &&
-           isPathClear(rowFrom, colFrom, rowTo, colTo);
-    
-   
-}
+    // Report progress until the workers finish
+    std::atomic<bool> stop(false);
+    Clock::time_point nextReport = start + std::chrono::seconds(10);
+    std::thread progress([&]() {
+        while (!stop.load()) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(100));
+            if (Clock::now() >= nextReport && !stop.load()) {
+                double elapsed = std::chrono::duration<double>(Clock::now() - start).count();
+                std::lock_guard<std::mutex> lock(reportMutex);
+                report << std::fixed << std::setprecision(1) << elapsed << " s: " << games.load() << " games, "
+                       << positions.load() << " positions, " << positions.load() / elapsed << " positions/s, "
+                       << failures.load() << " failures" << std::endl;
+                nextReport += std::chrono::seconds(10);
+            }
+        }
+    });
+    for (std::thread& worker : workers) {
+        worker.join();
+    }
+    stop = true;
+    progress.join();
 
-/**
- * The function returns the symbol 'Q' for a Queen chess piece.
- * 
- * @return The character 'Q' is being returned.
- */
-char Queen::getSymbol() const {
-    return 'Q';
+    double elapsed = std::chrono::duration<double>(Clock::now() - start).count();
+    std::cout << std::fixed << std::setprecision(1) << "Validation finished after " << elapsed << " s with "
+              << options.threads << " threads: " << games.load() << " games, " << positions.load()
+              << " positions, " << positions.load() / std::max(elapsed, 1e-9) << " positions/s, "
+              << failures.load() << " failures" << std::endl;
+    return failures.load() == 0;
 }
 
-// Implementation of member functions for King
-/**
- * The function checks if a move for a King piece in a chess game is valid by comparing the absolute
- * differences in row and column positions and returning true if both differences are less than or
- * equal to 1.
- * 
- * @param rowFrom The row index of the current position of the King piece on the chessboard.
- * @param colFrom The column index of the current position of the King.
- * @param rowTo The row index of the destination position where the King wants to move.
- * @param colTo The parameter "colTo" represents the column index of the destination position where the
- * King is being moved to.
- * 
- * @return a boolean value.
- */
-bool King::isValidMove(int rowFrom, int colFrom, int rowTo, int colTo) const {
-    // King movement logic
-    int rowDiff = std::abs(rowTo - rowFrom);
-     int colDiff = std::abs(colTo - colFrom);
-
-   return (rowDiff <= 1 && colDiff <= 1);
-    
-    
+// Print the usage of the command line tools and return the exit code for a usage error
+int printUsage() {
+    std::cerr << "Usage:\n"
+              << "  archive-convert <moves.txt> <out.cga>\n"
+              << "  archive-random <out.cga> <games> [seed]\n"
+              << "  archive-bench <archive.cga>\n"
+              << "  index-build <archive.cga> <out.cpi>\n"
+              << "  index-query <index.cpi> [moves...]\n"
+              << "  eval-stats <archive.cga>\n"
+              << "  search-bench [depth]\n"
+              << "  analyze [depth] [lines] [FEN]\n"
+              << "  perft <depth> [FEN]\n"
+              << "  pgn-import <games.pgn> [out.cga] [--threads N]\n"
+              << "  broadcast-bench [subscribers] [moves]\n"
+              << "  validate [--seconds S] [--threads N] [--archive games.cga] [--fen FEN]" << std::endl;
+    return 2;
 }
 
 /**
- * The function returns the symbol 'K' for the King piece.
- * 
- * @return The character 'K' is being returned.
+ * The function runs one of the command line tools. Usage:
+ *   archive-convert <moves.txt> <out.cga>     convert a text move log into an archive
+ *   archive-random <out.cga> <games> [seed]   write an archive of random games
+ *   archive-bench <archive.cga>               benchmark reading and replaying an archive
+ *   index-build <archive.cga> <out.cpi>       build the position index of an archive
+ *   index-query <index.cpi> [moves...]        list the games reaching the position after moves
+ *   eval-stats <archive.cga>                  evaluate every archived position, report pawn table hits
+ *   search-bench [depth]                      compare nodes, time to depth and pawn table hits of search features
+ *   analyze [depth] [lines] [FEN]             show the best lines of a position or the benchmark positions
+ *   perft <depth> [FEN]                       count the legal move tree of a position, per root move
+ *   pgn-import <games.pgn> [out.cga] [--threads N]
+ *                                             parse a PGN file in parallel, optionally into an archive
+ *   broadcast-bench [subscribers] [moves]     benchmark fanning moves out to spectators
+ *   validate [--seconds S] [--threads N] [--archive games.cga] [--fen FEN]
+ *                                             compare the fast move paths with the reference rules
+ *
+ * @return the process exit code.
  */
-char King::getSymbol() const {
-    return 'K';
+int runCommand(const std::vector<std::string>& args) {
+    const std::string& command = args[0];
+    if (command == "archive-convert" && args.size() == 3) {
+        return convertMoveLog(args[1], args[2]) ? 0 : 1;
+    }
+    if (command == "archive-random" && (args.size() == 3 || args.size() == 4)) {
+        std::uint32_t seed = args.size() == 4 ? static_cast<std::uint32_t>(std::stoul(args[3])) : 1;
+        return writeRandomArchive(args[1], std::stoull(args[2]), seed) ? 0 : 1;
+    }
+    if (command == "archive-bench" && args.size() == 2) {
+        return benchmarkArchive(args[1]) ? 0 : 1;
+    }
+    if (command == "index-build" && args.size() == 3) {
+        return buildPositionIndex(args[1], args[2]) ? 0 : 1;
+    }
+    if (command == "index-query" && args.size() >= 2) {
+        return queryPositionIndex(args[1], std::vector<std::string>(args.begin() + 2, args.end())) ? 0 : 1;
+    }
+    if (command == "eval-stats" && args.size() == 2) {
+        return printEvaluationStats(args[1]) ? 0 : 1;
+    }
+    if (command == "pgn-import" && args.size() >= 2) {
+        std::string archivePath;
+        unsigned threads = 0;
+        for (std::size_t i = 2; i < args.size(); ++i) {
+            if (args[i] == "--threads" && i + 1 < args.size()) {
+                threads = static_cast<unsigned>(std::stoul(args[++i]));
+            } else if (archivePath.empty() && args[i].compare(0, 2, "--") != 0) {
+                archivePath = args[i];
+            } else {
+                std::cerr << "Unknown option " << args[i] << std::endl;
+                return 2;
+            }
+        }
+        return importPgn(args[1], archivePath, threads) ? 0 : 1;
+    }
+#if !defined(_WIN32)
+    if (command == "broadcast-bench" && args.size() <= 3) {
+        return benchmarkBroadcast(args.size() >= 2 ? std::stoi(args[1]) : 256,
+                                  args.size() == 3 ? std::stoi(args[2]) : 10000) ? 0 : 1;
+    }
+#endif
+    if (command == "validate" && args.size() % 2 == 1) {
+        ValidationOptions options;
+        for (std::size_t i = 1; i < args.size(); i += 2) {
+            if (args[i] == "--seconds") {
+                options.seconds = std::stod(args[i + 1]);
+            } else if (args[i] == "--threads") {
+                options.threads = static_cast<unsigned>(std::stoul(args[i + 1]));
+            } else if (args[i] == "--archive") {
+                options.archivePath = args[i + 1];
+            } else if (args[i] == "--fen") {
+                options.fen = args[i + 1];
+            } else {
+                std::cerr << "Unknown option " << args[i] << std::endl;
+                return 2;
+            }
+        }
+        return runValidation(options) ? 0 : 1;
+    }
+    if (command == "search-bench" && args.size() <= 2) {
+        return benchmarkSearch(args.size() == 2 ? std::stoi(args[1]) : 6) ? 0 : 1;
+    }
+    if (command == "analyze" && args.size() <= 4) {
+        return runAnalysis(args.size() >= 2 ? std::stoi(args[1]) : 6, args.size() >= 3 ? std::stoi(args[2]) : 3,
+                           args.size() == 4 ? args[3] : std::string()) ? 0 : 1;
+    }
+    if (command == "perft" && (args.size() == 2 || args.size() == 3)) {
+        return runPerft(std::stoi(args[1]), args.size() == 3 ? args[2] : std::string()) ? 0 : 1;
+    }
+    return printUsage();
 }
 
-
-
 /**
  * This is a C++ program that allows two players to play a game of chess by taking turns entering the
- * positions of the pieces they want to move.
+ * positions of the pieces they want to move. When started with arguments it runs one of the command
+ * line tools of runCommand() instead.
  * 
  * @return The main function is returning an integer value of 0.
  */
 
-int main() {
+int main(int argc, char* argv[]) {
+    // Run a command line tool instead of the interactive game when arguments are given
+    if (argc > 1) {
+        try {
+            return runCommand(std::vector<std::string>(argv + 1, argv + argc));
+        } catch (const std::logic_error& e) {
+            // std::stoi and the other number parsers throw on malformed arguments
+            std::cerr << "Invalid argument: " << e.what() << std::endl;
+            return printUsage();
+        }
+    }
+
     /* The above code is declaring a variable named "chessBoard" of type ChessBoard. */
     /* The above code is declaring a variable named "chessBoard" of type ChessBoard. */
     ChessBoard chessBoard;